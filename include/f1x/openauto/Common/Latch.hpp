@@ -0,0 +1,65 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace common
+{
+
+// One-shot gate. Threads calling wait() block until some thread calls open();
+// after that wait() returns immediately. Opening it again is harmless.
+class Latch
+{
+public:
+    Latch()
+        : open_(false)
+    {
+    }
+
+    void open()
+    {
+        {
+            std::lock_guard<decltype(mutex_)> lock(mutex_);
+            open_ = true;
+        }
+
+        condition_.notify_all();
+    }
+
+    void wait()
+    {
+        std::unique_lock<decltype(mutex_)> lock(mutex_);
+        condition_.wait(lock, [this]() { return open_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool open_;
+};
+
+}
+}
+}
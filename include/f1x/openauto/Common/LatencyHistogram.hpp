@@ -0,0 +1,136 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace common
+{
+
+// Lock-free histogram of durations in microseconds. Values below 64us get a
+// bucket each; above that every power of two is split into 32 buckets, which
+// keeps percentiles within about 3% up to well past an hour. Any thread may
+// record while another reads.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram()
+    {
+        this->reset();
+    }
+
+    void record(uint64_t value)
+    {
+        ++buckets_[bucketIndex(value)];
+        ++count_;
+    }
+
+    void reset()
+    {
+        for(auto& bucket : buckets_)
+        {
+            bucket = 0;
+        }
+
+        count_ = 0;
+    }
+
+    uint64_t getCount() const
+    {
+        return count_;
+    }
+
+    // percentile in [0, 100]. Returns the upper bound of the bucket holding
+    // it, or 0 when nothing was recorded.
+    uint64_t getPercentile(double percentile) const
+    {
+        const uint64_t count = count_;
+
+        if(count == 0)
+        {
+            return 0;
+        }
+
+        const auto rank = static_cast<uint64_t>(percentile / 100.0 * (count - 1)) + 1;
+        uint64_t seen = 0;
+
+        for(size_t i = 0; i < cBucketCount; ++i)
+        {
+            seen += buckets_[i];
+
+            if(seen >= rank)
+            {
+                return bucketUpperBound(i);
+            }
+        }
+
+        return bucketUpperBound(cBucketCount - 1);
+    }
+
+private:
+    static constexpr unsigned cLinearBits = 6;
+    static constexpr unsigned cSubBucketBits = 5;
+    static constexpr size_t cBucketCount = (1 << cLinearBits) + (64 - cLinearBits) * (1 << cSubBucketBits);
+
+    static size_t bucketIndex(uint64_t value)
+    {
+        if(value < (1u << cLinearBits))
+        {
+            return static_cast<size_t>(value);
+        }
+
+        unsigned exponent = 63;
+        while((value >> exponent) == 0)
+        {
+            --exponent;
+        }
+
+        const auto subBucket = (value >> (exponent - cSubBucketBits)) & ((1u << cSubBucketBits) - 1);
+        return (1 << cLinearBits) + (exponent - cLinearBits) * (1 << cSubBucketBits) + subBucket;
+    }
+
+    static uint64_t bucketUpperBound(size_t index)
+    {
+        if(index < (1u << cLinearBits))
+        {
+            return index;
+        }
+
+        const auto exponent = (index - (1 << cLinearBits)) / (1 << cSubBucketBits) + cLinearBits;
+        const auto subBucket = (index - (1 << cLinearBits)) % (1 << cSubBucketBits);
+        const auto base = uint64_t(1) << exponent;
+        // Wraps to the maximum value for the very last bucket.
+        return base + (subBucket + 1) * (base >> cSubBucketBits) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, cBucketCount> buckets_;
+    std::atomic<uint64_t> count_;
+};
+
+}
+}
+}
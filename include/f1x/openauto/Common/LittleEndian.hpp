@@ -0,0 +1,70 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace common
+{
+
+// Fixed-width little endian integers for the capture files, independent of
+// the host byte order.
+template<typename T>
+void writeLittleEndian(std::ostream& stream, T value)
+{
+    uint8_t bytes[sizeof(T)];
+
+    for(size_t i = 0; i < sizeof(T); ++i)
+    {
+        bytes[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+
+    stream.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+template<typename T>
+bool readLittleEndian(std::istream& stream, T& value)
+{
+    uint8_t bytes[sizeof(T)];
+
+    if(!stream.read(reinterpret_cast<char*>(bytes), sizeof(T)))
+    {
+        return false;
+    }
+
+    value = 0;
+    for(size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(bytes[i]) << (i * 8);
+    }
+
+    return true;
+}
+
+}
+}
+}
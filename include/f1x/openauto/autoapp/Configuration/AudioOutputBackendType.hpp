@@ -32,6 +32,9 @@ enum class AudioOutputBackendType
     RTAUDIO,
     QT,
     GSTREAMER,
+    MIXER,
+    ALSA,
+    PIPEWIRE,
 };
 
 }
@@ -70,6 +70,8 @@ public:
     bool showNetworkinfo() const override;
     void hideWarning(bool value) override;
     bool hideWarning() const override;
+    std::string getSessionCapturePath() const override;
+    void setSessionCapturePath(const std::string& value) override;
 
     std::string getMp3MasterPath() const override;
     void setMp3MasterPath(const std::string& value) override;
@@ -98,6 +100,20 @@ public:
     int32_t getOMXLayerIndex() const override;
     void setVideoMargins(QRect value) override;
     QRect getVideoMargins() const override;
+    uint32_t getVideoMaxUnacked() const override;
+    void setVideoMaxUnacked(uint32_t value) override;
+    std::string getVideoGstDecoder() const override;
+    void setVideoGstDecoder(const std::string& value) override;
+    bool getVideoGstSync() const override;
+    void setVideoGstSync(bool value) override;
+    uint32_t getVideoDropThreshold() const override;
+    void setVideoDropThreshold(uint32_t value) override;
+    bool getVideoLatencyTracing() const override;
+    void setVideoLatencyTracing(bool value) override;
+    std::string getVideoCapturePath() const override;
+    void setVideoCapturePath(const std::string& value) override;
+    bool getVideoAudioSync() const override;
+    void setVideoAudioSync(bool value) override;
 
     bool getTouchscreenEnabled() const override;
     void setTouchscreenEnabled(bool value) override;
@@ -117,6 +133,36 @@ public:
     void setSpeechAudioChannelEnabled(bool value) override;
     AudioOutputBackendType getAudioOutputBackendType() const override;
     void setAudioOutputBackendType(AudioOutputBackendType value) override;
+    uint32_t getAudioJitterBufferLatency() const override;
+    void setAudioJitterBufferLatency(uint32_t value) override;
+    uint32_t getAudioMixerDuckLevel() const override;
+    void setAudioMixerDuckLevel(uint32_t value) override;
+    uint32_t getAudioMixerMediaGain() const override;
+    void setAudioMixerMediaGain(uint32_t value) override;
+    uint32_t getAudioMixerSpeechGain() const override;
+    void setAudioMixerSpeechGain(uint32_t value) override;
+    uint32_t getAudioMixerSystemGain() const override;
+    void setAudioMixerSystemGain(uint32_t value) override;
+    uint32_t getAudioFocusDuckLevel() const override;
+    void setAudioFocusDuckLevel(uint32_t value) override;
+    uint32_t getAudioMaxUnacked() const override;
+    void setAudioMaxUnacked(uint32_t value) override;
+    bool getAudioKeepOutputsOpen() const override;
+    void setAudioKeepOutputsOpen(bool value) override;
+    uint32_t getAudioPeriodSize() const override;
+    void setAudioPeriodSize(uint32_t value) override;
+    uint32_t getAudioPeriodCount() const override;
+    void setAudioPeriodCount(uint32_t value) override;
+    bool getAudioInputProcessing() const override;
+    void setAudioInputProcessing(bool value) override;
+    uint32_t getThreadIOServiceWorkers() const override;
+    void setThreadIOServiceWorkers(uint32_t value) override;
+    bool getThreadCpuAffinity() const override;
+    void setThreadCpuAffinity(bool value) override;
+    uint32_t getThreadMediaPriority() const override;
+    void setThreadMediaPriority(uint32_t value) override;
+    bool getThreadServiceExecutors() const override;
+    void setThreadServiceExecutors(bool value) override;
 
 private:
     void readButtonCodes(boost::property_tree::ptree& iniConfig);
@@ -136,6 +182,7 @@ private:
     bool hideBrightnessControl_;
     bool showNetworkinfo_;
     bool hideWarning_;
+    std::string sessionCapturePath_;
     std::string mp3MasterPath_;
     std::string mp3SubFolder_;
     int32_t mp3Track_;
@@ -148,6 +195,13 @@ private:
     size_t screenDPI_;
     int32_t omxLayerIndex_;
     QRect videoMargins_;
+    uint32_t videoMaxUnacked_;
+    std::string videoGstDecoder_;
+    bool videoGstSync_;
+    uint32_t videoDropThreshold_;
+    bool videoLatencyTracing_;
+    std::string videoCapturePath_;
+    bool videoAudioSync_;
     bool enableTouchscreen_;
     bool enablePlayerControl_;
     ButtonCodes buttonCodes_;
@@ -156,6 +210,21 @@ private:
     bool musicAudioChannelEnabled_;
     bool speechAudiochannelEnabled_;
     AudioOutputBackendType audioOutputBackendType_;
+    uint32_t audioJitterBufferLatency_;
+    uint32_t audioMixerDuckLevel_;
+    uint32_t audioMixerMediaGain_;
+    uint32_t audioMixerSpeechGain_;
+    uint32_t audioMixerSystemGain_;
+    uint32_t audioFocusDuckLevel_;
+    uint32_t audioMaxUnacked_;
+    bool audioKeepOutputsOpen_;
+    uint32_t audioPeriodSize_;
+    uint32_t audioPeriodCount_;
+    bool audioInputProcessing_;
+    uint32_t threadIOServiceWorkers_;
+    bool threadCpuAffinity_;
+    uint32_t threadMediaPriority_;
+    bool threadServiceExecutors_;
 
     static const std::string cConfigFileName;
 
@@ -171,6 +240,7 @@ private:
     static const std::string cGeneralHideBrightnessControlKey;
     static const std::string cGeneralShowNetworkinfoKey;
     static const std::string cGeneralHideWarningKey;
+    static const std::string cGeneralSessionCapturePathKey;
 
     static const std::string cGeneralHandednessOfTrafficTypeKey;
 
@@ -187,10 +257,32 @@ private:
     static const std::string cVideoOMXLayerIndexKey;
     static const std::string cVideoMarginWidth;
     static const std::string cVideoMarginHeight;
+    static const std::string cVideoMaxUnackedKey;
+    static const std::string cVideoGstDecoderKey;
+    static const std::string cVideoGstSyncKey;
+    static const std::string cVideoDropThresholdKey;
+    static const std::string cVideoLatencyTracingKey;
+    static const std::string cVideoCapturePathKey;
+    static const std::string cVideoAudioSyncKey;
 
     static const std::string cAudioMusicAudioChannelEnabled;
     static const std::string cAudioSpeechAudioChannelEnabled;
     static const std::string cAudioOutputBackendType;
+    static const std::string cAudioJitterBufferLatency;
+    static const std::string cAudioMixerDuckLevel;
+    static const std::string cAudioMixerMediaGain;
+    static const std::string cAudioMixerSpeechGain;
+    static const std::string cAudioMixerSystemGain;
+    static const std::string cAudioFocusDuckLevel;
+    static const std::string cAudioMaxUnacked;
+    static const std::string cAudioKeepOutputsOpen;
+    static const std::string cAudioPeriodSize;
+    static const std::string cAudioPeriodCount;
+    static const std::string cAudioInputProcessing;
+    static const std::string cThreadIOServiceWorkers;
+    static const std::string cThreadCpuAffinity;
+    static const std::string cThreadMediaPriority;
+    static const std::string cThreadServiceExecutors;
 
     static const std::string cBluetoothAdapterTypeKey;
     static const std::string cBluetoothRemoteAdapterAddressKey;
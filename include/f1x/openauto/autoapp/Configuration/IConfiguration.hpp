@@ -74,6 +74,8 @@ public:
     virtual bool showNetworkinfo() const = 0;
     virtual void hideWarning(bool value) = 0;
     virtual bool hideWarning() const = 0;
+    virtual std::string getSessionCapturePath() const = 0;
+    virtual void setSessionCapturePath(const std::string& value) = 0;
 
     virtual std::string getMp3MasterPath() const = 0;
     virtual void setMp3MasterPath(const std::string& value) = 0;
@@ -102,6 +104,20 @@ public:
     virtual int32_t getOMXLayerIndex() const = 0;
     virtual void setVideoMargins(QRect value) = 0;
     virtual QRect getVideoMargins() const = 0;
+    virtual uint32_t getVideoMaxUnacked() const = 0;
+    virtual void setVideoMaxUnacked(uint32_t value) = 0;
+    virtual std::string getVideoGstDecoder() const = 0;
+    virtual void setVideoGstDecoder(const std::string& value) = 0;
+    virtual bool getVideoGstSync() const = 0;
+    virtual void setVideoGstSync(bool value) = 0;
+    virtual uint32_t getVideoDropThreshold() const = 0;
+    virtual void setVideoDropThreshold(uint32_t value) = 0;
+    virtual bool getVideoLatencyTracing() const = 0;
+    virtual void setVideoLatencyTracing(bool value) = 0;
+    virtual std::string getVideoCapturePath() const = 0;
+    virtual void setVideoCapturePath(const std::string& value) = 0;
+    virtual bool getVideoAudioSync() const = 0;
+    virtual void setVideoAudioSync(bool value) = 0;
 
     virtual bool getTouchscreenEnabled() const = 0;
     virtual void setTouchscreenEnabled(bool value) = 0;
@@ -121,6 +137,36 @@ public:
     virtual void setSpeechAudioChannelEnabled(bool value) = 0;
     virtual AudioOutputBackendType getAudioOutputBackendType() const = 0;
     virtual void setAudioOutputBackendType(AudioOutputBackendType value) = 0;
+    virtual uint32_t getAudioJitterBufferLatency() const = 0;
+    virtual void setAudioJitterBufferLatency(uint32_t value) = 0;
+    virtual uint32_t getAudioMixerDuckLevel() const = 0;
+    virtual void setAudioMixerDuckLevel(uint32_t value) = 0;
+    virtual uint32_t getAudioMixerMediaGain() const = 0;
+    virtual void setAudioMixerMediaGain(uint32_t value) = 0;
+    virtual uint32_t getAudioMixerSpeechGain() const = 0;
+    virtual void setAudioMixerSpeechGain(uint32_t value) = 0;
+    virtual uint32_t getAudioMixerSystemGain() const = 0;
+    virtual void setAudioMixerSystemGain(uint32_t value) = 0;
+    virtual uint32_t getAudioFocusDuckLevel() const = 0;
+    virtual void setAudioFocusDuckLevel(uint32_t value) = 0;
+    virtual uint32_t getAudioMaxUnacked() const = 0;
+    virtual void setAudioMaxUnacked(uint32_t value) = 0;
+    virtual bool getAudioKeepOutputsOpen() const = 0;
+    virtual void setAudioKeepOutputsOpen(bool value) = 0;
+    virtual uint32_t getAudioPeriodSize() const = 0;
+    virtual void setAudioPeriodSize(uint32_t value) = 0;
+    virtual uint32_t getAudioPeriodCount() const = 0;
+    virtual void setAudioPeriodCount(uint32_t value) = 0;
+    virtual bool getAudioInputProcessing() const = 0;
+    virtual void setAudioInputProcessing(bool value) = 0;
+    virtual uint32_t getThreadIOServiceWorkers() const = 0;
+    virtual void setThreadIOServiceWorkers(uint32_t value) = 0;
+    virtual bool getThreadCpuAffinity() const = 0;
+    virtual void setThreadCpuAffinity(bool value) = 0;
+    virtual uint32_t getThreadMediaPriority() const = 0;
+    virtual void setThreadMediaPriority(uint32_t value) = 0;
+    virtual bool getThreadServiceExecutors() const = 0;
+    virtual void setThreadServiceExecutors(bool value) = 0;
 };
 
 }
@@ -0,0 +1,103 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#ifdef USE_ALSA
+
+#include <alsa/asoundlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Plays through an ALSA PCM with the period size and count given by the
+// configuration rather than whatever the device defaults to. A thread of its
+// own, at real-time priority where permitted, pulls one period at a time from
+// the jitter buffer and blocks in snd_pcm_writei(), so the device never holds
+// more than periodCount periods. Pointed at the "pipewire" PCM, this is also
+// the PipeWire backend.
+class AlsaAudioOutput: public IAudioOutput
+{
+public:
+    AlsaAudioOutput(std::string deviceName, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency,
+                    uint32_t periodSize, uint32_t periodCount);
+    ~AlsaAudioOutput() override;
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+    std::vector<AudioFormat> getSupportedFormats() const override;
+    bool setFormat(const AudioFormat& format) override;
+    AudioBufferStats getBufferStats() const override;
+    MediaClock::Pointer getMediaClock() const override;
+
+private:
+    bool configure(snd_pcm_t* pcm);
+    void close();
+    void run();
+    void promoteThread();
+
+    const std::string deviceName_;
+    const uint32_t requestedPeriodSize_;
+    const uint32_t requestedPeriodCount_;
+    uint32_t channelCount_;
+    uint32_t sampleSize_;
+    uint32_t sampleRate_;
+    AudioJitterBuffer audioBuffer_;
+    snd_pcm_t* pcm_;
+    snd_pcm_uframes_t periodSize_;
+    snd_pcm_uframes_t bufferSize_;
+    // Preallocated at open(); only touched by the playback thread after that.
+    std::vector<char> period_;
+    std::thread thread_;
+    // Only guards the playback thread going to sleep while suspended.
+    std::mutex mutex_;
+    std::condition_variable playingChanged_;
+    std::atomic<bool> running_;
+    std::atomic<bool> playing_;
+    std::atomic<uint64_t> xruns_;
+};
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+struct AudioBufferStats
+{
+    uint64_t underruns = 0;
+    uint64_t overruns = 0;
+    // All in milliseconds of audio. outputLatency is what the device queues
+    // after the buffer, as far as the output knows.
+    uint32_t depth = 0;
+    uint32_t targetLatency = 0;
+    uint32_t outputLatency = 0;
+    // Audio callbacks that ran longer than the audio they produced, and the
+    // longest one in percent of its period.
+    uint64_t callbackOverruns = 0;
+    uint32_t maxCallbackLoad = 0;
+};
+
+}
+}
+}
+}
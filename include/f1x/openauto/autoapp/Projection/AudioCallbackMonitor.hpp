@@ -0,0 +1,69 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Times audio callbacks against the period of audio they produce. A callback
+// that runs longer than its period has made the device wait, whatever the
+// buffer depth, so by default those are counted as overruns; stages that have
+// to share the period with others get a smaller budget. The worst load seen
+// gives an idea of the headroom left.
+//
+// Exactly one thread may record; any thread may read.
+class AudioCallbackMonitor: boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // budget is the share of the period a callback may take, in percent.
+    explicit AudioCallbackMonitor(uint32_t budget = 100);
+
+    static TimePoint now();
+    // period is the duration of the audio the callback produced, in
+    // microseconds. Returns whether the callback went over budget.
+    bool record(const TimePoint& start, uint64_t period);
+
+    uint64_t getOverruns() const;
+    // Longest callback so far, in percent of its period.
+    uint32_t getMaxLoad() const;
+
+private:
+    const uint32_t budget_;
+    std::atomic<uint64_t> overruns_;
+    std::atomic<uint32_t> maxLoad_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,97 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Common/Data.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioCallbackMonitor.hpp>
+#include <f1x/openauto/autoapp/Projection/EchoReference.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Cleans up microphone audio before it goes to the phone, in 10 ms frames.
+//
+// Echo cancellation runs an NLMS adaptive filter over the playback reference
+// and subtracts its estimate of the echo. The reference is read in lockstep
+// with the microphone, so the filter covers echo paths of up to its length
+// beyond whatever backlog the reference has at the start of the session.
+// Noise suppression tracks the noise floor from the quietest frames and
+// scales every frame down by how much of it is noise, without going below
+// a fixed floor.
+//
+// Every frame is timed against a fixed share of its duration. A frame that
+// goes over is reported and the echo filter is shortened, giving up its
+// longest echo paths first, until processing fits.
+//
+// Not thread-safe; meant to be driven from a single strand.
+class AudioInputProcessor: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<AudioInputProcessor> Pointer;
+
+    // echoReference may be null, in which case there is nothing to cancel.
+    AudioInputProcessor(uint32_t sampleRate, EchoReference::Pointer echoReference);
+
+    // Stages to run from now on; restarts adaptation.
+    void configure(bool echoCancellation, bool noiseSuppression);
+    bool isEnabled() const;
+    // Signed 16-bit mono samples, processed in place.
+    void process(aasdk::common::Data& data);
+
+    uint64_t getBudgetOverruns() const;
+    uint32_t getMaxLoad() const;
+
+private:
+    void processFrame(float* samples, size_t count);
+    void cancelEcho(float* samples, size_t count);
+    void suppressNoise(float* samples, size_t count);
+    void shortenFilter();
+
+    const uint32_t sampleRate_;
+    const size_t frameSize_;
+    EchoReference::Pointer echoReference_;
+    bool echoCancellation_;
+    bool noiseSuppression_;
+    AudioCallbackMonitor budgetMonitor_;
+
+    std::vector<float> frame_;
+    // Reversed, so that coefficient k lines up with history sample k.
+    std::vector<float> coefficients_;
+    // The last cFilterLength reference samples, followed by the frame's own.
+    std::vector<float> history_;
+    size_t filterLength_;
+
+    float noiseFloor_;
+    float gain_;
+};
+
+}
+}
+}
+}
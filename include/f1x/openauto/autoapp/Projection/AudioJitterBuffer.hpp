@@ -0,0 +1,158 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <QIODevice>
+#include <f1x/openauto/autoapp/Projection/AudioBufferStats.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioCallbackMonitor.hpp>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+#include <f1x/openauto/autoapp/Projection/RingBuffer.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// PCM FIFO between the thread receiving audio from the phone and the thread
+// feeding the sound card. It holds playback back until targetLatency worth of
+// audio is queued, pads underruns with silence and re-buffers after them, and
+// drops back to the target when a burst piles up more than twice that. The
+// target grows after every underrun and slowly shrinks back towards the
+// configured value while playback is stable; a flush or the end of a stream
+// puts it straight back. Running dry at the end of a stream is not an
+// underrun.
+//
+// Signed 16-bit samples can be scaled on their way out; gain changes are
+// ramped over a few tens of milliseconds so that ducking doesn't click.
+//
+// Timestamps pushed along with the audio are tracked to the byte and drive
+// the buffer's MediaClock as the audio is pulled out, assuming the device
+// plays a pulled chunk right after the one it is currently playing unless
+// the output tells it how much the device really has queued.
+//
+// Every pull() is timed against the duration of the audio it returns, which
+// for the outputs that feed the device straight from here is the whole of
+// their audio callback.
+//
+// Exactly one thread may push() and exactly one thread may pull(). pull()
+// never blocks, allocates or takes a lock.
+class AudioJitterBuffer: public QIODevice
+{
+public:
+    AudioJitterBuffer(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency);
+
+    bool isSequential() const override;
+    bool open(OpenMode mode) override;
+    qint64 bytesAvailable() const override;
+
+    // Producer side. timestamp is the media time of the first sample of data,
+    // in microseconds, or 0 if unknown.
+    size_t push(const char* data, size_t len, uint64_t timestamp = 0);
+    // Consumer side. Always fills len bytes, with silence if need be.
+    size_t pull(char* data, size_t len);
+    // Producer side. Nothing more is coming for the current stream, so
+    // running dry once the queued audio is played is expected.
+    void endOfStream();
+    // Consumer side, or while no consumer is running.
+    void flush();
+    // Any thread. Everything pushed so far is dropped by the next pull(),
+    // without the caller having to synchronise with the consumer.
+    void requestFlush();
+    // Pins the queued audio in RAM. Call before the consumer starts.
+    bool lockMemory();
+    // Any thread.
+    void setGain(float gain);
+    // Any thread. Audio the device holds ahead of a chunk just pulled, in
+    // microseconds; 0 if unknown.
+    void setOutputLatency(uint64_t latency);
+    // Neither side may be running. Drops whatever is queued.
+    void setFormat(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+
+    AudioBufferStats getStats() const;
+    const MediaClock::Pointer& getMediaClock() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    struct TimestampMark
+    {
+        size_t position;
+        uint64_t timestamp;
+    };
+
+    size_t durationToBytes(uint32_t duration) const;
+    uint64_t bytesToMicroseconds(size_t bytes) const;
+    void updateClock(size_t position, size_t len);
+    uint32_t bytesToDuration(size_t bytes) const;
+    void doPull(char* data, size_t len);
+    void onRefill();
+    void applyFlushRequest();
+    void applyGain(char* data, size_t len);
+
+    const uint32_t targetLatency_;
+    size_t frameSize_;
+    uint32_t sampleSize_;
+    uint32_t sampleRate_;
+    size_t minTargetDepth_;
+    size_t maxTargetDepth_;
+    size_t adaptStep_;
+    float gainStep_;
+    RingBuffer data_;
+    RingBuffer marks_;
+    MediaClock::Pointer clock_;
+    AudioCallbackMonitor callbackMonitor_;
+
+    // Only touched by the consumer.
+    bool priming_;
+    // Ran dry at drainPosition_; whether that was an underrun is only known
+    // once audio arrives again.
+    bool drained_;
+    size_t drainPosition_;
+    size_t stableBytes_;
+    float currentGain_;
+    TimestampMark currentMark_;
+    TimestampMark nextMark_;
+    bool hasCurrentMark_;
+    bool hasNextMark_;
+
+    std::atomic<size_t> targetDepth_;
+    // Write position up to which the next pull() drops data.
+    std::atomic<size_t> flushPosition_;
+    std::atomic<bool> flushRequested_;
+    // Write position at which the producer last ended a stream.
+    std::atomic<size_t> endPosition_;
+    std::atomic<bool> hasEndPosition_;
+    std::atomic<float> targetGain_;
+    std::atomic<uint64_t> outputLatency_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> overruns_;
+};
+
+}
+}
+}
+}
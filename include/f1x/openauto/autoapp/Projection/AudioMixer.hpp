@@ -0,0 +1,133 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <RtAudio.h>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Common/Data.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioBufferStats.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioCallbackMonitor.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
+#include <f1x/openauto/autoapp/Projection/EchoReference.hpp>
+#include <f1x/openauto/autoapp/Projection/PolyphaseResampler.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Plays any number of PCM streams through a single RtAudio stream at 48 kHz
+// stereo. Every source keeps its own jitter buffer and is resampled and
+// up-mixed to the device format in the audio callback, scaled by its gain.
+// While a source that ducks others is playing, everything else is turned
+// down to the duck level. Gain changes are ramped to avoid clicks.
+//
+// Sources live in a fixed table, so adding one never moves another while the
+// callback or a writer is using it; the slot of a removed source is reused.
+// The device stays open as long as any source is. The final mix can be tapped
+// as an echo reference.
+class AudioMixer: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<AudioMixer> Pointer;
+
+    static constexpr uint32_t cSampleRate = 48000;
+    static constexpr uint32_t cChannelCount = 2;
+    // Room for the channels of two overlapping sessions plus parked outputs.
+    static constexpr size_t cMaxSources = 12;
+    static constexpr size_t cNoSource = cMaxSources;
+
+    AudioMixer(float duckLevel);
+    ~AudioMixer();
+
+    // Returns cNoSource once the table is full; every call below ignores it.
+    size_t addSource(uint32_t channelCount, uint32_t sampleRate, uint32_t targetLatency, float gain, bool ducksOthers);
+    void removeSource(size_t source);
+    // Before the first source is opened.
+    void setEchoReference(EchoReference::Pointer echoReference);
+    bool open(size_t source);
+    void close(size_t source);
+    void write(size_t source, uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer);
+    void start(size_t source);
+    void suspend(size_t source);
+    void flush(size_t source);
+    void setGain(size_t source, float gain);
+    AudioBufferStats getBufferStats(size_t source) const;
+    MediaClock::Pointer getMediaClock(size_t source) const;
+
+private:
+    struct Source
+    {
+        Source(uint32_t channelCount, uint32_t sampleRate, uint32_t targetLatency, float gain, bool ducksOthers);
+
+        const uint32_t channelCount;
+        const bool ducksOthers;
+        AudioJitterBuffer buffer;
+        PolyphaseResampler resampler;
+        bool isOpen;
+        std::atomic<bool> active;
+        std::atomic<float> gain;
+        // Only touched by the audio callback.
+        float currentGain;
+        std::vector<int16_t> samples;
+        std::vector<float> input;
+        std::vector<float> output;
+    };
+
+    Source* getSource(size_t source) const;
+    bool openStream();
+    void closeStream();
+    void preallocate(size_t frames);
+    void preallocate(Source& source, size_t frames);
+    void mix(int16_t* output, size_t frames);
+    void mixSource(Source& source, size_t frames, float targetGain);
+    static int audioBufferReadHandler(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
+                                      double streamTime, RtAudioStreamStatus status, void* userData);
+
+    const float duckLevel_;
+    const float gainStep_;
+    std::array<std::unique_ptr<Source>, cMaxSources> sources_;
+    EchoReference::Pointer echoReference_;
+    std::unique_ptr<RtAudio> dac_;
+    size_t openSources_;
+    // Period of the open stream, 0 while it is closed.
+    size_t bufferFrames_;
+    std::vector<float> mixBuffer_;
+    std::vector<float> upmixBuffer_;
+    AudioCallbackMonitor callbackMonitor_;
+    // Serialises the audio callback against flushing sources and changing the
+    // source table; never held while starting or stopping the stream.
+    std::mutex mutex_;
+    std::mutex streamMutex_;
+};
+
+}
+}
+}
+}
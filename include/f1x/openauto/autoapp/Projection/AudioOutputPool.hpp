@@ -0,0 +1,73 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Keeps audio devices open between sessions. Outputs handed out by acquire()
+// only pause their device when stopped, and go back to the pool once the
+// session lets go of them, so the next session under the same key starts
+// playing without reopening anything. An output parked under a different
+// signature, i.e. created with settings that have changed since, is closed
+// rather than reused.
+class AudioOutputPool: public std::enable_shared_from_this<AudioOutputPool>, boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<AudioOutputPool> Pointer;
+    typedef std::function<IAudioOutput::Pointer()> Factory;
+
+    IAudioOutput::Pointer acquire(const std::string& key, const std::string& signature, const Factory& factory);
+    // Closes and drops every parked output.
+    void clear();
+
+private:
+    friend class PooledAudioOutput;
+
+    struct ParkedOutput
+    {
+        std::string signature;
+        IAudioOutput::Pointer output;
+        bool isOpen;
+    };
+
+    void park(const std::string& key, const std::string& signature, IAudioOutput::Pointer output, bool isOpen);
+
+    std::mutex mutex_;
+    std::map<std::string, ParkedOutput> parkedOutputs_;
+};
+
+}
+}
+}
+}
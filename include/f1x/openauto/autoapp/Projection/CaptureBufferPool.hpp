@@ -0,0 +1,65 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Fixed set of microphone buffers, handed out by value and given back once
+// the packet they carry has been sent. Moving a vector only moves its
+// storage, so once every buffer has gone round once a captured packet costs
+// no allocation.
+class CaptureBufferPool: boost::noncopyable
+{
+public:
+    CaptureBufferPool(size_t bufferCount, size_t bufferSize);
+
+    // Empty buffer with room for bufferSize bytes. Only allocates if every
+    // buffer of the pool is out.
+    aasdk::common::Data acquire();
+    void release(aasdk::common::Data data);
+    // Number of acquire() calls that had to allocate.
+    uint64_t getMisses() const;
+
+private:
+    const size_t bufferCount_;
+    const size_t bufferSize_;
+    std::mutex mutex_;
+    std::vector<aasdk::common::Data> freeBuffers_;
+    std::atomic<uint64_t> misses_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,76 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/autoapp/Projection/PolyphaseResampler.hpp>
+#include <f1x/openauto/autoapp/Projection/RingBuffer.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// What the speakers are playing, for the echo canceller to subtract from the
+// microphone: the mixed output as it is handed to the device, down-mixed to
+// mono and converted to the capture rate.
+//
+// Exactly one thread may write(), typically the audio callback, and exactly
+// one thread may read() and trim(). write() doesn't allocate.
+class EchoReference: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<EchoReference> Pointer;
+
+    EchoReference(uint32_t inputRate, uint32_t inputChannelCount, uint32_t outputRate);
+
+    // Producer side. Interleaved frames at the input rate and channel count.
+    void write(const float* frames, size_t frameCount);
+
+    // Consumer side. Reads at most count samples and returns the number read.
+    size_t read(float* samples, size_t count);
+    // Consumer side. Drops all but the newest keep samples.
+    void trim(size_t keep);
+    size_t available() const;
+
+private:
+    static constexpr size_t cMaxBlockFrames = 1024;
+
+    const uint32_t inputRate_;
+    const uint32_t inputChannelCount_;
+    const uint32_t outputRate_;
+    PolyphaseResampler resampler_;
+    // Down-mixed input the resampler hasn't consumed yet.
+    std::vector<float> pending_;
+    size_t pendingFrames_;
+    std::vector<float> converted_;
+    RingBuffer samples_;
+};
+
+}
+}
+}
+}
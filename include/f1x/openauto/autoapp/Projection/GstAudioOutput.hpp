@@ -25,6 +25,7 @@
 #include <gst/audio/audio-info.h>
 #include <gst/app/gstappsrc.h>
 
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
 #include <f1x/openauto/autoapp/Projection/GObjectDeleter.hpp>
 #include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
 
@@ -41,18 +42,28 @@ class GstAudioOutput: public IAudioOutput
 {
 
 public:
-    GstAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    GstAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency);
     bool open() override;
     void write(aasdk::messenger::Timestamp::ValueType, const aasdk::common::DataConstBuffer& buffer) override;
     void start() override;
     void stop() override;
     void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
     uint32_t getSampleSize() const override;
     uint32_t getChannelCount() const override;
     uint32_t getSampleRate() const override;
+    std::vector<AudioFormat> getSupportedFormats() const override;
+    bool setFormat(const AudioFormat& format) override;
+    AudioBufferStats getBufferStats() const override;
+    MediaClock::Pointer getMediaClock() const override;
 
 private:
+    static void onNeedData(GstAppSrc * appsrc, guint length, gpointer user_data);
+
     GstAudioInfo audioInfo_;
+    AudioJitterBuffer audioBuffer_;
+    size_t periodSize_;
     std::unique_ptr<GstPipeline, GObjectDeleter> gstPipeline_;
     std::unique_ptr<GstAppSrc, GObjectDeleter> appsrc_;
 };
@@ -0,0 +1,52 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// What a single Annex-B access unit from the phone contains, as far as frame
+// dropping is concerned.
+struct H264FrameInfo
+{
+    // SPS/PPS; must always reach the decoder.
+    bool hasParameterSets = false;
+    // Coded slices of an IDR picture.
+    bool isIdr = false;
+    // Any coded slice other parts of the stream may predict from.
+    bool isReference = false;
+    // Any coded slice at all.
+    bool hasSlices = false;
+};
+
+H264FrameInfo parseH264Frame(const aasdk::common::DataConstBuffer& buffer);
+
+}
+}
+}
+}
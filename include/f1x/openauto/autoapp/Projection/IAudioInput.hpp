@@ -43,6 +43,8 @@ public:
     virtual bool open() = 0;
     virtual bool isActive() const = 0;
     virtual void read(ReadPromise::Pointer promise) = 0;
+    // Hands back a buffer that came out of read() once it has been sent.
+    virtual void release(aasdk::common::Data data) = 0;
     virtual void start(StartPromise::Pointer promise) = 0;
     virtual void stop() = 0;
     virtual uint32_t getSampleSize() const = 0;
@@ -19,8 +19,12 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <aasdk/Messenger/Timestamp.hpp>
 #include <aasdk/Common/Data.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioBufferStats.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioFormat.hpp>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
 
 namespace f1x
 {
@@ -43,10 +47,28 @@ public:
     virtual void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) = 0;
     virtual void start() = 0;
     virtual void stop() = 0;
+    // Gives the device and the queued audio back while nobody listens, even
+    // where stop() keeps them for the next session; open() takes them again.
+    virtual void release()
+    {
+        this->stop();
+    }
     virtual void suspend() = 0;
+    // Drops whatever is queued for playback.
+    virtual void flush() = 0;
+    // Scales the output by gain (0..1); changes are ramped rather than applied in one step.
+    virtual void setGain(float gain) = 0;
     virtual uint32_t getSampleSize() const = 0;
     virtual uint32_t getChannelCount() const = 0;
     virtual uint32_t getSampleRate() const = 0;
+    // Formats the device plays without converting them, the one it prefers
+    // first. May be empty if the backend can't tell.
+    virtual std::vector<AudioFormat> getSupportedFormats() const = 0;
+    // Only while the output is stopped.
+    virtual bool setFormat(const AudioFormat& format) = 0;
+    virtual AudioBufferStats getBufferStats() const = 0;
+    // Follows the timestamps passed to write() as they are played.
+    virtual MediaClock::Pointer getMediaClock() const = 0;
 };
 
 }
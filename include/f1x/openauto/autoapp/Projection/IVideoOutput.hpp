@@ -23,6 +23,8 @@
 #include <aasdk_proto/VideoFPSEnum.pb.h>
 #include <aasdk_proto/VideoResolutionEnum.pb.h>
 #include <aasdk/Common/Data.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoBufferPool.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoLatencyTracer.hpp>
 
 namespace f1x
 {
@@ -43,8 +45,17 @@ public:
 
     virtual bool open() = 0;
     virtual bool init() = 0;
+    // timestamp is the presentation time of the frame in microseconds since
+    // the start of the stream. It is monotonic; the first frame is at 0.
     virtual void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) = 0;
+    // Same as write() for a frame the caller already copied out of the
+    // messenger; outputs that keep the data past the call hold on to the
+    // frame instead of copying it again.
+    virtual void writeFrame(uint64_t timestamp, VideoBufferPool::Buffer frame) = 0;
     virtual void stop() = 0;
+    // Number of frames written but not yet consumed by the decoder.
+    virtual size_t getQueueDepth() const = 0;
+    virtual void setLatencyTracer(VideoLatencyTracer::Pointer latencyTracer) = 0;
 
     virtual aasdk::proto::enums::VideoFPS::Enum getVideoFPS() const = 0;
     virtual aasdk::proto::enums::VideoResolution::Enum getVideoResolution() const = 0;
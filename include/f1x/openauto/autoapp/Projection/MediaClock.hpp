@@ -0,0 +1,75 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Playback position of an audio output, in the sender's media timestamps.
+// The output reports which timestamp it is about to hand to the device every
+// time it feeds it, and the clock extrapolates from that report until the
+// next one, so readers follow the sound card rather than the sender.
+//
+// Exactly one thread may update() and invalidate(); any thread may read.
+class MediaClock: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<MediaClock> Pointer;
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    MediaClock();
+
+    // timestamp will be heard delay microseconds from now.
+    void update(uint64_t timestamp, uint64_t delay);
+    // Nothing is playing until the next update().
+    void invalidate();
+
+    bool isValid() const;
+    // Timestamp being heard right now. False while nothing is playing.
+    bool getTime(uint64_t& timestamp) const;
+    // Local time at which timestamp is, or was, heard.
+    bool toLocalTime(uint64_t timestamp, TimePoint& localTime) const;
+
+private:
+    bool getAnchor(uint64_t& timestamp, int64_t& time) const;
+    static int64_t now();
+
+    // Sequence lock around the anchor: odd while the writer is updating it.
+    std::atomic<uint32_t> sequence_;
+    std::atomic<bool> valid_;
+    std::atomic<uint64_t> anchorTimestamp_;
+    std::atomic<int64_t> anchorTime_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,67 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <f1x/openauto/autoapp/Projection/AudioMixer.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// One channel's view of a shared AudioMixer.
+class MixerAudioOutput: public IAudioOutput
+{
+public:
+    MixerAudioOutput(AudioMixer::Pointer mixer, uint32_t channelCount, uint32_t sampleRate, uint32_t targetLatency, float gain, bool ducksOthers);
+    ~MixerAudioOutput() override;
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+    std::vector<AudioFormat> getSupportedFormats() const override;
+    bool setFormat(const AudioFormat& format) override;
+    AudioBufferStats getBufferStats() const override;
+    MediaClock::Pointer getMediaClock() const override;
+
+private:
+    AudioMixer::Pointer mixer_;
+    uint32_t channelCount_;
+    uint32_t sampleRate_;
+    float gain_;
+    size_t source_;
+};
+
+}
+}
+}
+}
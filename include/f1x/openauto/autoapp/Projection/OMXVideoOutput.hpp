@@ -24,6 +24,8 @@ extern "C"
 #include <ilclient.h>
 }
 
+#include <atomic>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -48,6 +50,7 @@ public:
     bool init() override;
     void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
     void stop() override;
+    size_t getQueueDepth() const override;
 
 private:
     bool createComponents();
@@ -55,10 +58,15 @@ private:
     bool setupTunnels();
     bool enablePortBuffers();
     bool setupDisplayRegion();
+    static void onEmptyBufferDone(void* userData, COMPONENT_T* component);
 
     std::mutex mutex_;
     bool isActive_;
     bool portSettingsChanged_;
+    bool clockStarted_;
+    std::atomic<size_t> buffersInFlight_;
+    std::mutex tracedBuffersMutex_;
+    std::deque<std::pair<uint64_t, bool>> tracedBuffers_;
     ILCLIENT_T* client_;
     COMPONENT_T* components_[5];
     TUNNEL_T tunnels_[4];
@@ -0,0 +1,72 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Rational sample rate converter: upsample by L, low-pass, decimate by M,
+// with the filter split into L phases so that only the taps that line up
+// with real input samples are evaluated. Works on interleaved float frames
+// and keeps the filter history between calls, so a stream can be converted
+// block by block.
+class PolyphaseResampler: boost::noncopyable
+{
+public:
+    PolyphaseResampler(uint32_t inputRate, uint32_t outputRate, uint32_t channelCount);
+
+    bool isPassthrough() const;
+    // Number of input frames the next process() call consumes.
+    size_t getInputFrames(size_t outputFrames) const;
+    void process(const float* input, float* output, size_t outputFrames);
+    void reset();
+
+private:
+    static constexpr size_t cTapsPerPhase = 16;
+
+    void designFilter();
+
+    uint32_t interpolation_;
+    uint32_t decimation_;
+    uint32_t channelCount_;
+    uint32_t phase_;
+    // Phase after phase, each one reversed so that it lines up with the
+    // input in memory order.
+    std::vector<float> coefficients_;
+    // Per channel: the last cTapsPerPhase input samples, followed by the
+    // samples of the block being converted.
+    std::vector<std::vector<float>> history_;
+};
+
+}
+}
+}
+}
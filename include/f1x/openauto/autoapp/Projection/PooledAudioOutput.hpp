@@ -0,0 +1,69 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <f1x/openauto/autoapp/Projection/AudioOutputPool.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// An output borrowed from an AudioOutputPool. stop() pauses the device
+// instead of closing it, and destroying the wrapper parks the output back in
+// the pool.
+class PooledAudioOutput: public IAudioOutput
+{
+public:
+    PooledAudioOutput(std::weak_ptr<AudioOutputPool> pool, std::string key, std::string signature, IAudioOutput::Pointer output, bool isOpen);
+    ~PooledAudioOutput() override;
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void release() override;
+    void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+    std::vector<AudioFormat> getSupportedFormats() const override;
+    bool setFormat(const AudioFormat& format) override;
+    AudioBufferStats getBufferStats() const override;
+    MediaClock::Pointer getMediaClock() const override;
+
+private:
+    std::weak_ptr<AudioOutputPool> pool_;
+    std::string key_;
+    std::string signature_;
+    IAudioOutput::Pointer output_;
+    bool isOpen_;
+};
+
+}
+}
+}
+}
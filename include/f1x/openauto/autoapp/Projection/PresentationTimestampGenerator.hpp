@@ -0,0 +1,71 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Turns the timestamps attached to incoming video frames into presentation
+// timestamps for IVideoOutput: microseconds since the start of the stream,
+// strictly increasing. Frames without a timestamp are stamped with their
+// arrival time; timestamped ones follow the sender's cadence, rebased onto
+// the local clock at the first timestamped frame.
+//
+// With media clocks attached, timestamped frames are instead due when the
+// audio output carrying the same timestamp plays it, so the picture follows
+// the sound card for as long as there is audio to follow.
+class PresentationTimestampGenerator
+{
+public:
+    PresentationTimestampGenerator();
+
+    // timestamp of 0 means the frame came without one.
+    uint64_t generate(uint64_t timestamp);
+    void reset();
+    // Clocks to slave to, in order of preference. Null entries, from outputs
+    // that have no clock, are skipped.
+    void setMediaClocks(std::vector<MediaClock::Pointer> mediaClocks);
+
+private:
+    bool getMediaTime(uint64_t timestamp, MediaClock::TimePoint& localTime) const;
+
+    std::vector<MediaClock::Pointer> mediaClocks_;
+    bool streamStarted_;
+    bool timestampAnchored_;
+    std::chrono::steady_clock::time_point streamStart_;
+    int64_t timestampOffset_;
+    uint64_t lastPresentationTimestamp_;
+};
+
+}
+}
+}
+}
@@ -21,7 +21,9 @@
 #include <mutex>
 #include <QAudioInput>
 #include <QAudioFormat>
+#include <f1x/openauto/autoapp/Projection/CaptureBufferPool.hpp>
 #include <f1x/openauto/autoapp/Projection/IAudioInput.hpp>
+#include <f1x/openauto/Common/Latch.hpp>
 
 namespace f1x
 {
@@ -37,10 +39,12 @@ class QtAudioInput: public QObject, public IAudioInput
     Q_OBJECT
 public:
     QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    ~QtAudioInput() override;
 
     bool open() override;
     bool isActive() const override;
     void read(ReadPromise::Pointer promise) override;
+    void release(aasdk::common::Data data) override;
     void start(StartPromise::Pointer promise) override;
     void stop() override;
     uint32_t getSampleSize() const override;
@@ -53,6 +57,7 @@ signals:
 
 private slots:
     void createAudioInput();
+    void destroyAudioInput();
     void onStartRecording(StartPromise::Pointer promise);
     void onStopRecording();
     void onReadyRead();
@@ -62,9 +67,13 @@ private:
     QIODevice* ioDevice_;
     std::unique_ptr<QAudioInput> audioInput_;
     ReadPromise::Pointer readPromise_;
+    CaptureBufferPool bufferPool_;
     mutable std::mutex mutex_;
+    common::Latch created_;
 
     static constexpr size_t cSampleSize = 2056;
+    // One being filled, one being sent and a couple in flight in between.
+    static constexpr size_t cBufferCount = 4;
 };
 
 }
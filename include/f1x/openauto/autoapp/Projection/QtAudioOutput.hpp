@@ -21,7 +21,8 @@
 #include <QAudioOutput>
 #include <QAudioFormat>
 #include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
-#include <f1x/openauto/autoapp/Projection/SequentialBuffer.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
+#include <f1x/openauto/Common/Latch.hpp>
 
 namespace f1x
 {
@@ -37,15 +38,22 @@ class QtAudioOutput: public QObject, public IAudioOutput
     Q_OBJECT
 
 public:
-    QtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    QtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency);
+    ~QtAudioOutput() override;
     bool open() override;
     void write(aasdk::messenger::Timestamp::ValueType, const aasdk::common::DataConstBuffer& buffer) override;
     void start() override;
     void stop() override;
     void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
     uint32_t getSampleSize() const override;
     uint32_t getChannelCount() const override;
     uint32_t getSampleRate() const override;
+    std::vector<AudioFormat> getSupportedFormats() const override;
+    bool setFormat(const AudioFormat& format) override;
+    AudioBufferStats getBufferStats() const override;
+    MediaClock::Pointer getMediaClock() const override;
 
 signals:
     void startPlayback();
@@ -54,15 +62,19 @@ signals:
 
 protected slots:
     void createAudioOutput();
+    bool recreateAudioOutput(int channelCount, int sampleSize, int sampleRate);
+    void destroyAudioOutput();
     void onStartPlayback();
     void onSuspendPlayback();
     void onStopPlayback();
 
 private:
+    // Only changed on the audio thread, while setFormat() waits for it.
     QAudioFormat audioFormat_;
-    QIODevice * audioBuffer_;
+    AudioJitterBuffer audioBuffer_;
     std::unique_ptr<QAudioOutput> audioOutput_;
     bool playbackStarted_;
+    common::Latch created_;
 };
 
 }
@@ -21,7 +21,9 @@
 
 #ifdef USE_GSTREAMER
 
+#include <atomic>
 #include <memory>
+#include <string>
 
 #include <QObject>
 #include <QQuickView>
@@ -33,7 +35,9 @@
 #include <boost/noncopyable.hpp>
 
 #include <f1x/openauto/autoapp/Projection/GObjectDeleter.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoBufferPool.hpp>
 #include <f1x/openauto/autoapp/Projection/VideoOutput.hpp>
+#include <f1x/openauto/Common/Latch.hpp>
 
 namespace f1x
 {
@@ -49,12 +53,15 @@ class QuickGstVideoOutput: public QObject, public VideoOutput, boost::noncopyabl
     Q_OBJECT
 
 public:
-    QuickGstVideoOutput(configuration::IConfiguration::Pointer configuration);
+    // A headless output decodes into a fakesink and never opens a window.
+    QuickGstVideoOutput(configuration::IConfiguration::Pointer configuration, bool headless = false);
     ~QuickGstVideoOutput();
     bool open() override;
     bool init() override;
     void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void writeFrame(uint64_t timestamp, VideoBufferPool::Buffer frame) override;
     void stop() override;
+    size_t getQueueDepth() const override;
 
 signals:
     void startPlayback();
@@ -67,12 +74,27 @@ protected slots:
 
 private:
     static void onGstMessage(GstBus * bus, GstMessage * message, gpointer user_data);
+    static void releaseBuffer(gpointer user_data);
+    static std::string selectDecoder(const std::string& decoder);
+    static void setPropertyIfExists(GstElement * element, const char * name, const char * value);
+    void buildVideoOutput();
+    std::string buildPipelineDescription() const;
+    void configureDecoder();
+    void installLatencyProbes();
+    void installQueueProbe();
+    uint64_t toStreamTimestamp(GstClockTime runningTime) const;
+    static GstPadProbeReturn onDecodedBuffer(GstPad * pad, GstPadProbeInfo * info, gpointer user_data);
+    static GstPadProbeReturn onRenderedBuffer(GstPad * pad, GstPadProbeInfo * info, gpointer user_data);
+    static GstPadProbeReturn onDecoderInput(GstPad * pad, GstPadProbeInfo * info, gpointer user_data);
+    GstClockTime toRunningTime(uint64_t timestamp);
 
     std::unique_ptr<GstPipeline, GObjectDeleter> gstPipeline_;
     std::unique_ptr<QWidget> widgetWrapper_;
 
     std::unique_ptr<GstAppSrc, GObjectDeleter> appsrc_;
-    std::unique_ptr<GstElement, GObjectDeleter> qmlglsink_;
+    std::unique_ptr<GstElement, GObjectDeleter> videosink_;
+    VideoBufferPool::Pointer bufferPool_;
+    bool headless_;
 
     /* Owned by widgetWrapper_ */
     QQuickView * quickView_;
@@ -80,6 +102,15 @@ private:
     QQuickItem * videoItem_;
 
     gulong onGstMessageHandlerId;
+    common::Latch created_;
+    // Frames pushed into appsrc and frames that have reached the decoder;
+    // the difference is what waits in appsrc, h264parse and the queue.
+    std::atomic<uint64_t> framesPushed_;
+    std::atomic<uint64_t> framesToDecoder_;
+
+    // Written on the output strand, read by the streaming-thread probes.
+    std::atomic<bool> ptsAnchored_;
+    std::atomic<GstClockTimeDiff> ptsOffset_;
 };
 
 }
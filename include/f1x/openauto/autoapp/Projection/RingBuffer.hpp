@@ -0,0 +1,87 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Lock-free byte FIFO for exactly one producer thread and one consumer thread.
+// The capacity is rounded up to a power of two so that positions wrap with a
+// mask, and the two indices live on separate cache lines so the producer and
+// the consumer don't keep stealing the same line from each other.
+class RingBuffer: boost::noncopyable
+{
+public:
+    RingBuffer(size_t capacity);
+    ~RingBuffer();
+
+    // Producer side. Writes as much of data as fits and returns the number of
+    // bytes actually written.
+    size_t write(const char* data, size_t len);
+
+    // Consumer side. Reads at most len bytes and returns the number read.
+    size_t read(char* data, size_t len);
+    // Consumer side. Drops at most len bytes and returns the number dropped.
+    size_t skip(size_t len);
+    // Consumer side. Drops everything that has been written so far.
+    void clear();
+    // Drops everything and changes the capacity. Neither side may be running.
+    void reset(size_t capacity);
+    // Pins the storage in RAM, now and after every reset(), so that neither
+    // side ever takes a page fault on it. Fails if RLIMIT_MEMLOCK is too low.
+    bool lock();
+
+    size_t size() const;
+    size_t capacity() const;
+    // Total number of bytes written and consumed so far. Both wrap around.
+    size_t writePosition() const;
+    size_t readPosition() const;
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value);
+
+    static constexpr size_t cCacheLineSize = 64;
+
+    std::vector<char> data_;
+    size_t mask_;
+    bool locked_;
+
+    char padding0_[cCacheLineSize];
+    std::atomic<size_t> writeIndex_;
+    char padding1_[cCacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> readIndex_;
+    char padding2_[cCacheLineSize - sizeof(std::atomic<size_t>)];
+};
+
+}
+}
+}
+}
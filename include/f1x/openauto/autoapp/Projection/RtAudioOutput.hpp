@@ -20,7 +20,7 @@
 
 #include <RtAudio.h>
 #include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
-#include <f1x/openauto/autoapp/Projection/SequentialBuffer.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
 
 namespace f1x
 {
@@ -34,15 +34,21 @@ namespace projection
 class RtAudioOutput: public IAudioOutput
 {
 public:
-    RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency);
     bool open() override;
     void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
     void start() override;
     void stop() override;
     void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
     uint32_t getSampleSize() const override;
     uint32_t getChannelCount() const override;
     uint32_t getSampleRate() const override;
+    std::vector<AudioFormat> getSupportedFormats() const override;
+    bool setFormat(const AudioFormat& format) override;
+    AudioBufferStats getBufferStats() const override;
+    MediaClock::Pointer getMediaClock() const override;
 
 private:
     void doSuspend();
@@ -52,8 +58,9 @@ private:
     uint32_t channelCount_;
     uint32_t sampleSize_;
     uint32_t sampleRate_;
-    SequentialBuffer audioBuffer_;
+    AudioJitterBuffer audioBuffer_;
     std::unique_ptr<RtAudio> dac_;
+    // Serialises opening, starting and stopping; never taken by the callback.
     std::mutex mutex_;
 };
 
@@ -18,10 +18,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <QIODevice>
-#include <mutex>
-#include <boost/circular_buffer.hpp>
 #include <aasdk/Common/Data.hpp>
+#include <f1x/openauto/autoapp/Projection/RingBuffer.hpp>
 
 namespace f1x
 {
@@ -32,10 +32,14 @@ namespace autoapp
 namespace projection
 {
 
+// QIODevice over a lock-free ring buffer. Exactly one thread may write and
+// exactly one thread may read, so a real-time audio callback never waits on
+// the network thread that feeds it. A write that doesn't fit is rejected as
+// a whole, so the reader never gets a truncated frame.
 class SequentialBuffer: public QIODevice
 {
 public:
-    SequentialBuffer();
+    SequentialBuffer(size_t capacity = aasdk::common::cStaticDataSize);
     bool isSequential() const override;
     qint64 size() const override;
     qint64 pos() const override;
@@ -51,8 +55,10 @@ protected:
     qint64 writeData(const char *data, qint64 len) override;
 
 private:
-    boost::circular_buffer<aasdk::common::Data::value_type> data_;
-    mutable std::mutex mutex_;
+    RingBuffer data_;
+    std::atomic<bool> readyReadPending_;
+    // Producer side only.
+    uint64_t droppedWrites_;
 };
 
 }
@@ -0,0 +1,171 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OPENAUTO_SIMD_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define OPENAUTO_SIMD_SSE
+#endif
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+namespace simd
+{
+
+// Inner loops of the audio mixer. NEON on ARM boards, SSE2 on x86, plain C++
+// elsewhere; each vector path finishes the tail with the scalar loop.
+
+inline float dotProduct(const float* a, const float* b, size_t count)
+{
+    size_t i = 0;
+    float sum = 0.0f;
+    const size_t vectorCount = count & ~static_cast<size_t>(3);
+
+#if defined(OPENAUTO_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for(; i < vectorCount; i += 4)
+    {
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    const float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#elif defined(OPENAUTO_SIMD_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for(; i < vectorCount; i += 4)
+    {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+
+    for(; i < count; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+// destination[i] += source[i] * gain
+inline void mixInto(float* destination, const float* source, float gain, size_t count)
+{
+    size_t i = 0;
+
+#if defined(OPENAUTO_SIMD_NEON)
+    for(; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(destination + i, vmlaq_n_f32(vld1q_f32(destination + i), vld1q_f32(source + i), gain));
+    }
+#elif defined(OPENAUTO_SIMD_SSE)
+    const __m128 factor = _mm_set1_ps(gain);
+    for(; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), factor)));
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        destination[i] += source[i] * gain;
+    }
+}
+
+inline void int16ToFloat(const int16_t* source, float* destination, size_t count)
+{
+    size_t i = 0;
+
+#if defined(OPENAUTO_SIMD_NEON)
+    for(; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(destination + i, vcvtq_f32_s32(vmovl_s16(vld1_s16(source + i))));
+    }
+#elif defined(OPENAUTO_SIMD_SSE)
+    for(; i + 8 <= count; i += 8)
+    {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        // Sign-extend by interleaving with the samples themselves and shifting back.
+        _mm_storeu_ps(destination + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)));
+        _mm_storeu_ps(destination + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)));
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        destination[i] = source[i];
+    }
+}
+
+// Rounds and saturates to the int16 range.
+inline void floatToInt16(const float* source, int16_t* destination, size_t count)
+{
+    size_t i = 0;
+
+#if defined(OPENAUTO_SIMD_NEON)
+    const float32x4_t positiveHalf = vdupq_n_f32(0.5f);
+    const float32x4_t negativeHalf = vdupq_n_f32(-0.5f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for(; i + 8 <= count; i += 8)
+    {
+        // vcvtq_s32_f32 truncates, so round away from zero first; the
+        // conversion and vqmovn_s32 both saturate.
+        const float32x4_t low = vld1q_f32(source + i);
+        const float32x4_t high = vld1q_f32(source + i + 4);
+        const int32x4_t lowRounded = vcvtq_s32_f32(vaddq_f32(low, vbslq_f32(vcltq_f32(low, zero), negativeHalf, positiveHalf)));
+        const int32x4_t highRounded = vcvtq_s32_f32(vaddq_f32(high, vbslq_f32(vcltq_f32(high, zero), negativeHalf, positiveHalf)));
+        vst1q_s16(destination + i, vcombine_s16(vqmovn_s32(lowRounded), vqmovn_s32(highRounded)));
+    }
+#elif defined(OPENAUTO_SIMD_SSE)
+    // Clamp before converting: out of range values would come back as INT_MIN.
+    const __m128 maximum = _mm_set1_ps(32767.0f);
+    const __m128 minimum = _mm_set1_ps(-32768.0f);
+    for(; i + 8 <= count; i += 8)
+    {
+        const __m128i low = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i), maximum), minimum));
+        const __m128i high = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i + 4), maximum), minimum));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(low, high));
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        const float value = source[i] + (source[i] < 0.0f ? -0.5f : 0.5f);
+        destination[i] = value >= 32767.0f ? 32767 : value <= -32768.0f ? -32768 : static_cast<int16_t>(value);
+    }
+}
+
+}
+}
+}
+}
+}
@@ -0,0 +1,61 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Hands out owning, ref-counted frame buffers whose storage goes back to the
+// pool once the last reference is dropped, so that a decoder holding on to a
+// frame doesn't cost a fresh allocation for every packet.
+class VideoBufferPool: public std::enable_shared_from_this<VideoBufferPool>, boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<VideoBufferPool> Pointer;
+    typedef std::shared_ptr<aasdk::common::Data> Buffer;
+
+    static Pointer create(size_t maxFreeBuffers);
+
+    Buffer acquire(const aasdk::common::DataConstBuffer& source);
+
+private:
+    VideoBufferPool(size_t maxFreeBuffers);
+    void release(aasdk::common::Data* data);
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<aasdk::common::Data>> freeBuffers_;
+    size_t maxFreeBuffers_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,70 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Decides which frames to skip while the decoder is behind. Once the queue
+// depth reaches the threshold, non-reference frames are dropped; they cost
+// nothing to lose. If that is not enough and the depth reaches twice the
+// threshold, everything is dropped until the next IDR frame, which brings the
+// latency back down within one GOP; the caller is asked to request one from
+// the phone. Frames after a skip reference what was dropped, so nothing goes
+// through until an IDR arrives; should none come within cMaxSkippedFrames the
+// keyframe is requested again. Parameter sets always go through.
+class VideoFrameDropPolicy
+{
+public:
+    // A threshold of 0 disables dropping.
+    VideoFrameDropPolicy(size_t threshold);
+
+    static constexpr uint32_t cMaxSkippedFrames = 60;
+
+    bool shouldDrop(const aasdk::common::DataConstBuffer& buffer, size_t queueDepth);
+    // True once for every skip to the next IDR, and again every
+    // cMaxSkippedFrames while it lasts; the caller should then ask the phone
+    // for a keyframe.
+    bool takeKeyframeRequest();
+    void reset();
+    uint64_t getDroppedFrames() const;
+
+private:
+    size_t threshold_;
+    bool waitingForIdr_;
+    bool keyframeRequested_;
+    uint32_t skippedFrames_;
+    uint64_t droppedFrames_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,87 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// A video stream as VideoService received it: "OAVF", a version word and
+// then one record per frame holding the arrival time, the phone's timestamp
+// and the payload. All integers are little endian.
+struct VideoFrameRecord
+{
+    // Microseconds since the first frame arrived.
+    uint64_t arrivalTime = 0;
+    // As sent by the phone; 0 if the frame came without one.
+    uint64_t timestamp = 0;
+    aasdk::common::Data payload;
+};
+
+class VideoFrameLogWriter: boost::noncopyable
+{
+public:
+    bool open(const std::string& path);
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer);
+    void close();
+    bool isOpen() const;
+
+private:
+    std::ofstream file_;
+    std::chrono::steady_clock::time_point start_;
+    bool started_ = false;
+};
+
+// Reads frame logs, or a raw Annex-B H.264 elementary stream split into
+// access units that arrive every frameInterval microseconds.
+class VideoFrameLogReader: boost::noncopyable
+{
+public:
+    bool open(const std::string& path, uint64_t frameInterval);
+    bool read(VideoFrameRecord& record);
+    bool isAnnexB() const;
+
+private:
+    bool readAnnexB(VideoFrameRecord& record);
+    size_t findNextAccessUnit(size_t offset) const;
+
+    std::ifstream file_;
+    bool annexB_ = false;
+    aasdk::common::Data annexBData_;
+    size_t annexBOffset_ = 0;
+    uint64_t frameInterval_ = 0;
+    uint64_t frameCount_ = 0;
+};
+
+}
+}
+}
+}
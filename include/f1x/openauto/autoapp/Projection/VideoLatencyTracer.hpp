@@ -0,0 +1,90 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/Common/LatencyHistogram.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Follows video frames, identified by their presentation timestamp, through
+// the pipeline and keeps a latency histogram per stage measured from the
+// moment the frame arrived from the phone. Stages a backend cannot observe
+// simply stay empty. When disabled, every call returns right away.
+class VideoLatencyTracer: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<VideoLatencyTracer> Pointer;
+
+    enum class Stage
+    {
+        RECEIVED,
+        ENQUEUED,
+        // The decoder took the frame in; where its output can't be seen.
+        DECODER_INPUT,
+        DECODED,
+        RENDERED
+    };
+
+    VideoLatencyTracer(bool enabled);
+
+    bool isEnabled() const;
+    void record(Stage stage, uint64_t timestamp);
+    // Same, for a stage that is known to complete at a later point in time,
+    // e.g. a frame the sink will hold until it is due.
+    void record(Stage stage, uint64_t timestamp, uint64_t delay);
+    void dump() const;
+    // Frames that made it to the given stage with a matching RECEIVED.
+    uint64_t getFrameCount(Stage stage) const;
+    void reset();
+
+private:
+    static constexpr size_t cStageCount = 5;
+    static constexpr size_t cFrameSlots = 256;
+
+    struct Frame
+    {
+        uint64_t timestamp;
+        uint64_t receiveTime;
+    };
+
+    static uint64_t now();
+    static const char* stageName(Stage stage);
+
+    const bool enabled_;
+    mutable std::mutex mutex_;
+    std::array<Frame, cFrameSlots> frames_;
+    std::array<common::LatencyHistogram, cStageCount> histograms_;
+};
+
+}
+}
+}
+}
@@ -39,9 +39,13 @@ public:
     aasdk::proto::enums::VideoResolution::Enum getVideoResolution() const override;
     size_t getScreenDPI() const override;
     QRect getVideoMargins() const override;
+    size_t getQueueDepth() const override;
+    void writeFrame(uint64_t timestamp, VideoBufferPool::Buffer frame) override;
+    void setLatencyTracer(VideoLatencyTracer::Pointer latencyTracer) override;
 
 protected:
     configuration::IConfiguration::Pointer configuration_;
+    VideoLatencyTracer::Pointer latencyTracer_;
 };
 
 }
@@ -26,6 +26,7 @@
 #include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
 #include <f1x/openauto/autoapp/Service/IAndroidAutoEntity.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
+#include <f1x/openauto/autoapp/Service/IServiceFactory.hpp>
 #include <f1x/openauto/autoapp/Service/IPinger.hpp>
 
 namespace f1x
@@ -45,7 +46,8 @@ public:
                       aasdk::transport::ITransport::Pointer transport,
                       aasdk::messenger::IMessenger::Pointer messenger,
                       configuration::IConfiguration::Pointer configuration,
-                      ServiceList serviceList,
+                      IServiceFactory& serviceFactory,
+                      StartupTimeline::Pointer timeline,
                       IPinger::Pointer pinger);
     ~AndroidAutoEntity() override;
 
@@ -67,19 +69,28 @@ public:
 
 private:
     using std::enable_shared_from_this<AndroidAutoEntity>::shared_from_this;
+    void onServicesCreated(ServiceList serviceList);
+    void sendServiceDiscoveryResponse();
     void triggerQuit();
     void schedulePing();
     void sendPing();
 
+    boost::asio::io_service& ioService_;
     boost::asio::io_service::strand strand_;
     aasdk::messenger::ICryptor::Pointer cryptor_;
     aasdk::transport::ITransport::Pointer transport_;
     aasdk::messenger::IMessenger::Pointer messenger_;
     aasdk::channel::control::IControlServiceChannel::Pointer controlServiceChannel_;
     configuration::IConfiguration::Pointer configuration_;
+    IServiceFactory& serviceFactory_;
+    StartupTimeline::Pointer timeline_;
+    // Filled in once the services have been created next to the handshake.
     ServiceList serviceList_;
     IPinger::Pointer pinger_;
     IAndroidAutoEntityEventHandler* eventHandler_;
+    bool servicesCreated_;
+    bool serviceDiscoveryPending_;
+    bool stopped_;
 };
 
 }
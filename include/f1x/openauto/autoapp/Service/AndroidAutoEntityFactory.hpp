@@ -20,6 +20,7 @@
 
 #include <boost/asio.hpp>
 #include <aasdk/Transport/ITransport.hpp>
+#include <aasdk/Transport/ISSLWrapper.hpp>
 #include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
 #include <f1x/openauto/autoapp/Service/IAndroidAutoEntityFactory.hpp>
 #include <f1x/openauto/autoapp/Service/IServiceFactory.hpp>
@@ -49,6 +50,9 @@ private:
     boost::asio::io_service& ioService_;
     configuration::IConfiguration::Pointer configuration_;
     IServiceFactory& serviceFactory_;
+    // Shared by the cryptors of all connections so that a reconnect can
+    // resume the previous TLS session.
+    aasdk::transport::ISSLWrapper::Pointer sslWrapper_;
 };
 
 }
@@ -21,6 +21,7 @@
 #include <aasdk/Channel/AV/AVInputServiceChannel.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
 #include <f1x/openauto/autoapp/Projection/IAudioInput.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioInputProcessor.hpp>
 
 namespace f1x
 {
@@ -36,13 +37,17 @@ class AudioInputService: public aasdk::channel::av::IAVInputServiceChannelEventH
 public:
     typedef std::shared_ptr<AudioInputService> Pointer;
 
-    AudioInputService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioInput::Pointer audioInput);
+    // processor may be null, in which case the microphone goes out untouched.
+    AudioInputService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioInput::Pointer audioInput,
+                      projection::AudioInputProcessor::Pointer processor);
 
     void start() override;
     void stop() override;
     void pause() override;
     void resume() override;
     void fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response) override;
+    aasdk::messenger::ChannelId getChannelId() const override;
+    void onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType) override;
     void onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request) override;
     void onAVChannelSetupRequest(const aasdk::proto::messages::AVChannelSetupRequest& request) override;
     void onAVInputOpenRequest(const aasdk::proto::messages::AVInputOpenRequest& request) override;
@@ -53,11 +58,16 @@ private:
     using std::enable_shared_from_this<AudioInputService>::shared_from_this;
     void onAudioInputOpenSucceed();
     void onAudioInputDataReady(aasdk::common::Data data);
+    void sendAudioInput(aasdk::common::Data data);
     void readAudioInput();
 
     boost::asio::io_service::strand strand_;
     aasdk::channel::av::AVInputServiceChannel::Pointer channel_;
     projection::IAudioInput::Pointer audioInput_;
+    projection::AudioInputProcessor::Pointer processor_;
+    // Processing runs here, on whichever worker is free, rather than
+    // holding up the channel.
+    boost::asio::io_service::strand processingStrand_;
     int32_t session_;
 };
 
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <boost/asio/deadline_timer.hpp>
 #include <aasdk/Channel/AV/IAudioServiceChannel.hpp>
 #include <aasdk/Channel/AV/IAudioServiceChannelEventHandler.hpp>
 #include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
@@ -37,13 +38,15 @@ class AudioService: public aasdk::channel::av::IAudioServiceChannelEventHandler,
 public:
     typedef std::shared_ptr<AudioService> Pointer;
 
-    AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput);
+    AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked);
 
     void start() override;
     void stop() override;
     void pause() override;
     void resume() override;
     void fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response) override;
+    aasdk::messenger::ChannelId getChannelId() const override;
+    void onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType) override;
     void onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request) override;
     void onAVChannelSetupRequest(const aasdk::proto::messages::AVChannelSetupRequest& request) override;
     void onAVChannelStartIndication(const aasdk::proto::messages::AVChannelStartIndication& indication) override;
@@ -54,11 +57,30 @@ public:
 
 protected:
     using std::enable_shared_from_this<AudioService>::shared_from_this;
+    // Releases the output while another stream holds focus; media is still
+    // acknowledged but dropped until resumeOutput().
+    void suspendOutput();
+    void resumeOutput();
+    projection::AudioFormat getCurrentFormat() const;
+    bool selectFormat(const projection::AudioFormat& format);
+    bool isOutputFull() const;
+    void scheduleAck();
+    void onAckTimerExpired(const boost::system::error_code& e);
+    void sendAVMediaAckIndication();
 
     boost::asio::io_service::strand strand_;
+    boost::asio::deadline_timer ackTimer_;
     aasdk::channel::av::IAudioServiceChannel::Pointer channel_;
     projection::IAudioOutput::Pointer audioOutput_;
     int32_t session_;
+    uint32_t maxUnacked_;
+    // Packets received and not acknowledged yet.
+    uint32_t unackedPackets_;
+    bool ackScheduled_;
+    // Formats advertised to the phone, in the order of its config indices.
+    std::vector<projection::AudioFormat> audioFormats_;
+    bool outputOpen_;
+    bool outputSuspended_;
 };
 
 }
@@ -40,6 +40,8 @@ public:
     void pause() override;
     void resume() override;
     void fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response) override;
+    aasdk::messenger::ChannelId getChannelId() const override;
+    void onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType) override;
     void onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request) override;
     void onBluetoothPairingRequest(const aasdk::proto::messages::BluetoothPairingRequest& request) override;
     void onChannelError(const aasdk::error::Error& e) override;
@@ -0,0 +1,106 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Transport/ISSLWrapper.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+// Outlives the connections and lets every Cryptor after the first skip the
+// expensive parts of its setup: the certificate, the private key and the
+// SSL_CTX are parsed and configured once, and the session of the last
+// completed handshake is offered to the phone so that a reconnect can
+// resume it instead of redoing the key exchange. A session the phone
+// rejects costs nothing, a handshake that fails drops it.
+class CachingSSLWrapper: public aasdk::transport::ISSLWrapper, boost::noncopyable
+{
+public:
+    explicit CachingSSLWrapper(aasdk::transport::ISSLWrapper::Pointer sslWrapper);
+    ~CachingSSLWrapper() override;
+
+    X509* readCertificate(const std::string& certificate) override;
+    EVP_PKEY* readPrivateKey(const std::string& privateKey) override;
+    const SSL_METHOD* getMethod() override;
+    SSL_CTX* createContext(const SSL_METHOD* method) override;
+    bool useCertificate(SSL_CTX* context, X509* certificate) override;
+    bool usePrivateKey(SSL_CTX* context, EVP_PKEY* privateKey) override;
+    SSL* createInstance(SSL_CTX* context) override;
+    bool checkPrivateKey(SSL* ssl) override;
+    BIOs createBIOs() override;
+    void setBIOs(SSL* ssl, const BIOs& bIOs, size_t maxBufferSize) override;
+    void setConnectState(SSL* ssl) override;
+    int doHandshake(SSL* ssl) override;
+    int getError(SSL* ssl, int returnCode) override;
+    void free(SSL* ssl) override;
+    void free(SSL_CTX* context) override;
+    void free(BIO* bio) override;
+    void free(X509* certificate) override;
+    void free(EVP_PKEY* privateKey) override;
+
+    size_t bioCtrlPending(BIO* b) override;
+    int bioRead(BIO *b, void *data, int len) override;
+    int bioWrite(BIO *b, const void *data, int len) override;
+
+    int getAvailableBytes(const SSL* ssl) override;
+    int sslRead(SSL *ssl, void *buf, int num) override;
+    int sslWrite(SSL *ssl, const void *buf, int num) override;
+
+private:
+    struct Handshake
+    {
+        std::chrono::steady_clock::time_point start;
+        std::chrono::nanoseconds cpuTime;
+        bool sessionOffered;
+    };
+
+    static std::chrono::nanoseconds threadCpuTime();
+
+    aasdk::transport::ISSLWrapper::Pointer sslWrapper_;
+
+    std::mutex mutex_;
+    std::string certificatePem_;
+    X509* certificate_;
+    std::string privateKeyPem_;
+    EVP_PKEY* privateKey_;
+    const SSL_METHOD* method_;
+    SSL_CTX* context_;
+    bool certificateUsed_;
+    bool privateKeyUsed_;
+    SSL_SESSION* session_;
+    std::map<SSL*, Handshake> handshakes_;
+    uint32_t fullHandshakes_;
+    uint32_t resumedHandshakes_;
+};
+
+}
+}
+}
+}
@@ -21,6 +21,8 @@
 #include <vector>
 #include <memory>
 #include <aasdk_proto/ServiceDiscoveryResponseMessage.pb.h>
+#include <aasdk_proto/AudioFocusTypeEnum.pb.h>
+#include <aasdk/Messenger/ChannelId.hpp>
 
 namespace f1x
 {
@@ -43,6 +45,9 @@ public:
     virtual void pause() = 0;
     virtual void resume() = 0;
     virtual void fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response) = 0;
+    // The channel the service receives on, NONE if it has no channel.
+    virtual aasdk::messenger::ChannelId getChannelId() const = 0;
+    virtual void onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType) = 0;
 };
 
 typedef std::vector<IService::Pointer> ServiceList;
@@ -20,6 +20,7 @@
 
 #include <aasdk/Messenger/IMessenger.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
+#include <f1x/openauto/autoapp/Service/StartupTimeline.hpp>
 
 namespace f1x
 {
@@ -35,7 +36,7 @@ class IServiceFactory
 public:
     virtual ~IServiceFactory() = default;
 
-    virtual ServiceList create(aasdk::messenger::IMessenger::Pointer messenger) = 0;
+    virtual ServiceList create(aasdk::messenger::IMessenger::Pointer messenger, StartupTimeline::Pointer timeline) = 0;
 };
 
 }
@@ -33,7 +33,12 @@ namespace service
 class MediaAudioService: public AudioService
 {
 public:
-    MediaAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput);
+    MediaAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked, float duckLevel);
+
+    void onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType) override;
+
+private:
+    float duckLevel_;
 };
 
 }
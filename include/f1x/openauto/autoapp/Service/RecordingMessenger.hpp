@@ -0,0 +1,56 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Messenger/IMessenger.hpp>
+#include <f1x/openauto/autoapp/Service/SessionLog.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+// Passes everything through to the wrapped messenger and logs each message
+// on its way, after decryption and before encryption.
+class RecordingMessenger: public aasdk::messenger::IMessenger, boost::noncopyable
+{
+public:
+    RecordingMessenger(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, SessionLogWriter::Pointer log);
+
+    void enqueueReceive(aasdk::messenger::ChannelId channelId, aasdk::messenger::ReceivePromise::Pointer promise) override;
+    void enqueueSend(aasdk::messenger::Message::Pointer message, aasdk::messenger::SendPromise::Pointer promise) override;
+    void stop() override;
+
+private:
+    boost::asio::io_service& ioService_;
+    aasdk::messenger::IMessenger::Pointer messenger_;
+    SessionLogWriter::Pointer log_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,108 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <set>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+#include <aasdk/IO/Promise.hpp>
+#include <aasdk/Messenger/IMessenger.hpp>
+#include <f1x/openauto/autoapp/Service/SessionLog.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+// Stands in for the phone: hands the incoming messages of a session log to
+// the channels at their original times, scaled by speed (0 replays as fast
+// as the channels take them), and swallows whatever the services send. The
+// control channel is left out, since the handshake belongs to
+// AndroidAutoEntity rather than to the services. The replay only begins
+// once every expected channel is listening, so no message depends on how
+// quickly a service got to its first receive.
+class ReplayMessenger: public aasdk::messenger::IMessenger, public std::enable_shared_from_this<ReplayMessenger>, boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<ReplayMessenger> Pointer;
+    typedef aasdk::io::Promise<void> Promise;
+
+    struct ChannelStatistics
+    {
+        uint64_t received = 0;
+        uint64_t receivedBytes = 0;
+        uint64_t sent = 0;
+        // Messages for a channel that was not expected.
+        uint64_t dropped = 0;
+        // Longest run of messages due but not yet taken by the channel.
+        size_t maxBacklog = 0;
+    };
+    typedef std::map<aasdk::messenger::ChannelId, ChannelStatistics> Statistics;
+    typedef std::set<aasdk::messenger::ChannelId> ChannelIds;
+
+    ReplayMessenger(boost::asio::io_service& ioService, SessionLogReader::Pointer log, double speed);
+
+    // channelIds are the channels there are services for. Resolved once the
+    // log is exhausted and every message was taken.
+    void start(ChannelIds channelIds, Promise::Pointer promise);
+    void enqueueReceive(aasdk::messenger::ChannelId channelId, aasdk::messenger::ReceivePromise::Pointer promise) override;
+    void enqueueSend(aasdk::messenger::Message::Pointer message, aasdk::messenger::SendPromise::Pointer promise) override;
+    void stop() override;
+    // Only meaningful once the replay has finished.
+    Statistics getStatistics() const;
+
+private:
+    using std::enable_shared_from_this<ReplayMessenger>::shared_from_this;
+
+    void startIfListening();
+    bool readNext();
+    void scheduleNext();
+    void onTimerExpired(const boost::system::error_code& error);
+    void queue(const SessionRecord& record);
+    void deliver(aasdk::messenger::ChannelId channelId);
+    void checkFinished();
+
+    boost::asio::io_service::strand strand_;
+    boost::asio::deadline_timer timer_;
+    SessionLogReader::Pointer log_;
+    double speed_;
+    std::chrono::steady_clock::time_point start_;
+    SessionRecord next_;
+    bool hasNext_;
+    bool exhausted_;
+    bool started_;
+    Promise::Pointer promise_;
+    ChannelIds channelIds_;
+    std::map<aasdk::messenger::ChannelId, std::deque<aasdk::messenger::Message::Pointer>> messages_;
+    std::map<aasdk::messenger::ChannelId, std::deque<aasdk::messenger::ReceivePromise::Pointer>> receivePromises_;
+    Statistics statistics_;
+};
+
+}
+}
+}
+}
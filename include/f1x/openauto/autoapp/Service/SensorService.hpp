@@ -44,6 +44,8 @@ public:
     void pause() override;
     void resume() override;
     void fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response) override;
+    aasdk::messenger::ChannelId getChannelId() const override;
+    void onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType) override;
     void onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request) override;
     void onSensorStartRequest(const aasdk::proto::messages::SensorStartRequestMessage& request) override;
     void onChannelError(const aasdk::error::Error& e) override;
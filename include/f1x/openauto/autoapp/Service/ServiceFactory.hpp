@@ -18,8 +18,14 @@
 
 #pragma once
 
+#include <mutex>
 #include <f1x/openauto/autoapp/Service/IServiceFactory.hpp>
+#include <f1x/openauto/autoapp/Service/ThreadTopology.hpp>
 #include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioOutputPool.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioMixer.hpp>
+#include <f1x/openauto/autoapp/Projection/EchoReference.hpp>
 
 namespace f1x
 {
@@ -33,17 +39,27 @@ namespace service
 class ServiceFactory: public IServiceFactory
 {
 public:
-    ServiceFactory(boost::asio::io_service& ioService, configuration::IConfiguration::Pointer configuration);
-    ServiceList create(aasdk::messenger::IMessenger::Pointer messenger) override;
+    ServiceFactory(ThreadTopology& threadTopology, configuration::IConfiguration::Pointer configuration);
+    ServiceList create(aasdk::messenger::IMessenger::Pointer messenger, StartupTimeline::Pointer timeline) override;
 
 private:
-    IService::Pointer createVideoService(aasdk::messenger::IMessenger::Pointer messenger);
+    IService::Pointer createVideoService(aasdk::messenger::IMessenger::Pointer messenger, std::vector<projection::MediaClock::Pointer> mediaClocks, StartupTimeline::Pointer timeline);
     IService::Pointer createBluetoothService(aasdk::messenger::IMessenger::Pointer messenger);
     IService::Pointer createInputService(aasdk::messenger::IMessenger::Pointer messenger);
-    void createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger);
+    void createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger, std::vector<projection::MediaClock::Pointer>& mediaClocks);
 
-    boost::asio::io_service& ioService_;
+    // Decides which executor each service dispatches on.
+    ThreadTopology& threadTopology_;
     configuration::IConfiguration::Pointer configuration_;
+    // create() runs on whichever io thread picks it up, and a reconnect can
+    // overlap the teardown of the previous session; guards the state below.
+    std::mutex mutex_;
+    // Outlive the sessions, so that a reconnect finds the audio devices open.
+    projection::AudioOutputPool::Pointer audioOutputPool_;
+    projection::AudioMixer::Pointer audioMixer_;
+    // Fed by every mixer this factory creates; the only playback the echo
+    // canceller gets to see.
+    projection::EchoReference::Pointer echoReference_;
 };
 
 }
@@ -0,0 +1,90 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Messenger/Message.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+// Every message that went through the messenger of one session, in plain
+// text: "OASL", a version word and then one record per message holding the
+// time, direction, channel, the message's encryption and type flags and its
+// payload. All integers are little endian.
+enum class SessionLogDirection: uint8_t
+{
+    IN,
+    OUT
+};
+
+struct SessionRecord
+{
+    // Microseconds since the log was opened.
+    uint64_t time = 0;
+    SessionLogDirection direction = SessionLogDirection::IN;
+    aasdk::messenger::ChannelId channelId = aasdk::messenger::ChannelId::NONE;
+    aasdk::messenger::EncryptionType encryptionType = aasdk::messenger::EncryptionType::PLAIN;
+    aasdk::messenger::MessageType messageType = aasdk::messenger::MessageType::SPECIFIC;
+    aasdk::common::Data payload;
+};
+
+// Written to from the strands of all channels at once.
+class SessionLogWriter: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<SessionLogWriter> Pointer;
+
+    bool open(const std::string& path);
+    void write(SessionLogDirection direction, const aasdk::messenger::Message& message);
+
+private:
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+class SessionLogReader: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<SessionLogReader> Pointer;
+
+    bool open(const std::string& path);
+    bool read(SessionRecord& record);
+
+private:
+    std::ifstream file_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,64 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+// Milestones of one session's bring-up, timed from the moment the entity was
+// created. Marked from the strands of several services at once.
+class StartupTimeline: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<StartupTimeline> Pointer;
+
+    StartupTimeline();
+
+    // Only the first mark of a milestone counts.
+    void mark(const std::string& milestone);
+    // Logs the milestones marked so far, once per session.
+    void log();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::mutex mutex_;
+    Clock::time_point start_;
+    std::vector<std::pair<std::string, Clock::duration>> milestones_;
+    bool logged_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,144 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
+#include <f1x/openauto/autoapp/Service/USBEventSource.hpp>
+#include <f1x/openauto/Common/LatencyHistogram.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+enum class TransportType
+{
+    NONE,
+    USB,
+    TCP
+};
+
+// Services of one class share an io_service, so that a burst of work in
+// one class cannot hold up dispatching in another. CONTROL is the shared
+// io_service that also runs the messenger and the transport.
+enum class ExecutorClass
+{
+    VIDEO,
+    AUDIO,
+    // Microphone capture and its echo cancellation.
+    CAPTURE,
+    INPUT,
+    CONTROL
+};
+
+// Owns the worker threads behind the io_service. Pool sizes follow the core
+// count, and libusb is driven from the shared io_service instead of threads
+// of its own. Workers the active transport doesn't need are parked. Media and
+// input services get io_services of their own unless Threads.ServiceExecutors
+// is off.
+class ThreadTopology: boost::noncopyable
+{
+public:
+    // usbContext may be null, in which case libusb events are not handled.
+    ThreadTopology(boost::asio::io_service& ioService, libusb_context* usbContext, configuration::IConfiguration::Pointer configuration);
+
+    void start();
+    // Stops every io_service, including the shared one.
+    void stop();
+    // Must have returned before the topology is destroyed.
+    void join();
+    // Called by the app whenever a session starts or ends. Resizes the shared
+    // pool for the transport. Queue delays are only sampled while a session
+    // runs, and logged when it ends.
+    void setActiveTransport(TransportType transport);
+
+    size_t getIOServiceWorkerCount() const;
+    boost::asio::io_service& getIOService(ExecutorClass executorClass);
+    // Time handlers of the class spend queued before a thread picks them up,
+    // in microseconds, during the last session.
+    const common::LatencyHistogram& getQueueDelay(ExecutorClass executorClass) const;
+
+private:
+    struct Executor
+    {
+        // Runs on sharedIOService if given, otherwise on an io_service of its own.
+        Executor(boost::asio::io_service* sharedIOService, size_t threadCount, int priority);
+
+        // Null for the shared io_service.
+        std::unique_ptr<boost::asio::io_service> ownedIOService;
+        std::unique_ptr<boost::asio::io_service::work> work;
+        boost::asio::io_service& ioService;
+        size_t threadCount;
+        int priority;
+        // The probe and the histogram are only touched on probeStrand, so a
+        // reset never races a sample.
+        boost::asio::io_service::strand probeStrand;
+        boost::asio::steady_timer probeTimer;
+        bool probing;
+        common::LatencyHistogram queueDelay;
+    };
+
+    static constexpr size_t cExecutorClassCount = 5;
+
+    void executorWorker(Executor& executor, const std::string& name);
+    void resizeIOServicePool(TransportType transport);
+    void park();
+    void startProbe(Executor& executor);
+    void stopProbe(Executor& executor, ExecutorClass executorClass);
+    void scheduleProbe(Executor& executor);
+    void pinThread(const std::vector<unsigned int>& cpus, const std::string& name);
+    void promoteThread(int priority, const std::string& name);
+
+    boost::asio::io_service& ioService_;
+    configuration::IConfiguration::Pointer configuration_;
+    unsigned int cpuCount_;
+    size_t ioServiceWorkerCount_;
+    std::vector<unsigned int> ioServiceCpus_;
+    std::unique_ptr<USBEventSource> usbEventSource_;
+    std::array<std::unique_ptr<Executor>, cExecutorClassCount> executors_;
+    std::vector<std::thread> threadPool_;
+    std::atomic<TransportType> activeTransport_;
+
+    // A parked worker sits in a handler of the shared io_service until it is
+    // no longer needed there; parkedWorkers_ counts those posted.
+    std::mutex parkMutex_;
+    std::condition_variable parkChanged_;
+    size_t parkTarget_;
+    size_t parkedWorkers_;
+    bool stopping_;
+};
+
+}
+}
+}
+}
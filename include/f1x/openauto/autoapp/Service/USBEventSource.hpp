@@ -0,0 +1,89 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+#include <libusb.h>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+// Drives libusb from an io_service: its pollfds are watched by the asio
+// reactor and events are handled without blocking once one is readable, so
+// transfers complete on the io_service threads and no thread sits in
+// libusb_handle_events. Hotplug notifications arrive the same way. All event
+// handling runs on one strand.
+class USBEventSource: boost::noncopyable
+{
+public:
+    USBEventSource(boost::asio::io_service& ioService, libusb_context* usbContext);
+
+    void start();
+    // Leaves the file descriptors to libusb; must be called before libusb_exit.
+    void stop();
+
+private:
+    struct Watch
+    {
+        Watch(boost::asio::io_service& ioService, int fd, short events);
+        ~Watch();
+
+        boost::asio::posix::stream_descriptor descriptor;
+        int fd;
+        short events;
+    };
+
+    void addWatch(int fd, short events);
+    void removeWatch(int fd);
+    void arm(const std::shared_ptr<Watch>& watch, boost::asio::posix::stream_descriptor::wait_type waitType);
+    void onReady(const std::shared_ptr<Watch>& watch, boost::asio::posix::stream_descriptor::wait_type waitType);
+    void drainEvents();
+    bool hasPendingEvents();
+    void handleEvents();
+    void scheduleTimeout();
+
+    static void onPollfdAdded(int fd, short events, void* userData);
+    static void onPollfdRemoved(int fd, void* userData);
+
+    boost::asio::io_service& ioService_;
+    libusb_context* usbContext_;
+    boost::asio::io_service::strand strand_;
+    boost::asio::steady_timer timer_;
+    bool handlesTimeouts_;
+    std::atomic<bool> started_;
+
+    std::mutex mutex_;
+    std::map<int, std::shared_ptr<Watch>> watches_;
+};
+
+}
+}
+}
+}
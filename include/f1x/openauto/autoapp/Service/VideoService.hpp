@@ -19,10 +19,18 @@
 #pragma once
 
 #include <memory>
+#include <boost/asio/signal_set.hpp>
 #include <aasdk/Channel/AV/VideoServiceChannel.hpp>
 #include <aasdk/Channel/AV/IVideoServiceChannelEventHandler.hpp>
 #include <f1x/openauto/autoapp/Projection/IVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoBufferPool.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoFrameDropPolicy.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoLatencyTracer.hpp>
+#include <f1x/openauto/autoapp/Projection/PresentationTimestampGenerator.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoFrameLog.hpp>
+#include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
+#include <f1x/openauto/autoapp/Service/StartupTimeline.hpp>
 
 namespace f1x
 {
@@ -38,13 +46,17 @@ class VideoService: public aasdk::channel::av::IVideoServiceChannelEventHandler,
 public:
     typedef std::shared_ptr<VideoService> Pointer;
 
-    VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput);
+    VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput,
+                 std::vector<projection::MediaClock::Pointer> mediaClocks, configuration::IConfiguration::Pointer configuration,
+                 StartupTimeline::Pointer timeline);
 
     void start() override;
     void stop() override;
     void pause() override;
     void resume() override;
     void fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response) override;
+    aasdk::messenger::ChannelId getChannelId() const override;
+    void onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType) override;
     void onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request) override;
     void onAVChannelSetupRequest(const aasdk::proto::messages::AVChannelSetupRequest& request) override;
     void onAVChannelStartIndication(const aasdk::proto::messages::AVChannelStartIndication& indication) override;
@@ -57,11 +69,29 @@ public:
 private:
     using std::enable_shared_from_this<VideoService>::shared_from_this;
     void sendVideoFocusIndication();
+    void queueFrame(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer);
+    void onFrameWritten();
+    void markFirstFrame();
+    void sendAVMediaAckIndication();
+    void waitForDumpSignal();
 
     boost::asio::io_service::strand strand_;
+    boost::asio::io_service::strand outputStrand_;
     aasdk::channel::av::VideoServiceChannel::Pointer channel_;
     projection::IVideoOutput::Pointer videoOutput_;
     int32_t session_;
+    uint32_t maxUnacked_;
+    uint32_t pendingFrames_;
+    uint32_t deferredAcks_;
+    projection::VideoBufferPool::Pointer bufferPool_;
+    projection::VideoFrameDropPolicy dropPolicy_;
+    projection::VideoLatencyTracer::Pointer latencyTracer_;
+    boost::asio::signal_set dumpSignals_;
+    projection::PresentationTimestampGenerator timestampGenerator_;
+    std::string capturePath_;
+    projection::VideoFrameLogWriter captureLog_;
+    StartupTimeline::Pointer timeline_;
+    bool firstFrameWritten_;
 };
 
 }
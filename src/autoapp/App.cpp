@@ -30,7 +30,8 @@ namespace autoapp
 {
 
 App::App(boost::asio::io_service& ioService, aasdk::usb::USBWrapper& usbWrapper, aasdk::tcp::ITCPWrapper& tcpWrapper, service::IAndroidAutoEntityFactory& androidAutoEntityFactory,
-         aasdk::usb::IUSBHub::Pointer usbHub, aasdk::usb::IConnectedAccessoriesEnumerator::Pointer connectedAccessoriesEnumerator)
+         aasdk::usb::IUSBHub::Pointer usbHub, aasdk::usb::IConnectedAccessoriesEnumerator::Pointer connectedAccessoriesEnumerator,
+         service::ThreadTopology& threadTopology)
     : ioService_(ioService)
     , usbWrapper_(usbWrapper)
     , tcpWrapper_(tcpWrapper)
@@ -39,6 +40,7 @@ App::App(boost::asio::io_service& ioService, aasdk::usb::USBWrapper& usbWrapper,
     , usbHub_(std::move(usbHub))
     , connectedAccessoriesEnumerator_(std::move(connectedAccessoriesEnumerator))
     , acceptor_(ioService, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), 5000 ))
+    , threadTopology_(threadTopology)
     , isStopped_(false)
 {
 
@@ -96,12 +98,14 @@ void App::start(aasdk::tcp::ITCPEndpoint::SocketPointer socket)
             auto tcpEndpoint(std::make_shared<aasdk::tcp::TCPEndpoint>(tcpWrapper_, std::move(socket)));
             androidAutoEntity_ = androidAutoEntityFactory_.create(std::move(tcpEndpoint));
             androidAutoEntity_->start(*this);
+            threadTopology_.setActiveTransport(service::TransportType::TCP);
         }
         catch(const aasdk::error::Error& error)
         {
             OPENAUTO_LOG(error) << "[App] TCP AndroidAutoEntity create error: " << error.what();
 
             //androidAutoEntity_.reset();
+            threadTopology_.setActiveTransport(service::TransportType::NONE);
             this->waitForDevice();
         }
     });
@@ -135,6 +139,8 @@ void App::stop()
                 OPENAUTO_LOG(error) << "[App] stop: exception caused by androidAutoEntity_.reset();";
             }
         }
+
+        threadTopology_.setActiveTransport(service::TransportType::NONE);
     });
 
 }
@@ -159,6 +165,7 @@ void App::aoapDeviceHandler(aasdk::usb::DeviceHandle deviceHandle)
             auto aoapDevice(aasdk::usb::AOAPDevice::create(usbWrapper_, ioService_, deviceHandle));
             androidAutoEntity_ = androidAutoEntityFactory_.create(std::move(aoapDevice));
             androidAutoEntity_->start(*this);
+            threadTopology_.setActiveTransport(service::TransportType::USB);
         } else {
             OPENAUTO_LOG(info) << "[App] Start Android Auto not allowed - skip.";
         }
@@ -255,6 +262,8 @@ void App::onAndroidAutoQuit()
             }
         }
 
+        threadTopology_.setActiveTransport(service::TransportType::NONE);
+
         if(!isStopped_)
         {
             try {
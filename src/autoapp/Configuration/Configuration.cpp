@@ -43,6 +43,7 @@ const std::string Configuration::cGeneralShowCursorKey = "General.ShowCursor";
 const std::string Configuration::cGeneralHideBrightnessControlKey = "General.HideBrightnessControl";
 const std::string Configuration::cGeneralShowNetworkinfoKey = "General.ShowNetworkinfo";
 const std::string Configuration::cGeneralHideWarningKey = "General.HideWarning";
+const std::string Configuration::cGeneralSessionCapturePathKey = "General.SessionCapturePath";
 
 const std::string Configuration::cGeneralHandednessOfTrafficTypeKey = "General.HandednessOfTrafficType";
 
@@ -59,10 +60,32 @@ const std::string Configuration::cVideoScreenDPIKey = "Video.ScreenDPI";
 const std::string Configuration::cVideoOMXLayerIndexKey = "Video.OMXLayerIndex";
 const std::string Configuration::cVideoMarginWidth = "Video.MarginWidth";
 const std::string Configuration::cVideoMarginHeight = "Video.MarginHeight";
+const std::string Configuration::cVideoMaxUnackedKey = "Video.MaxUnacked";
+const std::string Configuration::cVideoGstDecoderKey = "Video.GstDecoder";
+const std::string Configuration::cVideoGstSyncKey = "Video.GstSync";
+const std::string Configuration::cVideoDropThresholdKey = "Video.DropThreshold";
+const std::string Configuration::cVideoLatencyTracingKey = "Video.LatencyTracing";
+const std::string Configuration::cVideoCapturePathKey = "Video.CapturePath";
+const std::string Configuration::cVideoAudioSyncKey = "Video.AudioSync";
 
 const std::string Configuration::cAudioMusicAudioChannelEnabled = "Audio.MusicAudioChannelEnabled";
 const std::string Configuration::cAudioSpeechAudioChannelEnabled = "Audio.SpeechAudioChannelEnabled";
 const std::string Configuration::cAudioOutputBackendType = "Audio.OutputBackendType";
+const std::string Configuration::cAudioJitterBufferLatency = "Audio.JitterBufferLatency";
+const std::string Configuration::cAudioMixerDuckLevel = "Audio.MixerDuckLevel";
+const std::string Configuration::cAudioMixerMediaGain = "Audio.MixerMediaGain";
+const std::string Configuration::cAudioMixerSpeechGain = "Audio.MixerSpeechGain";
+const std::string Configuration::cAudioMixerSystemGain = "Audio.MixerSystemGain";
+const std::string Configuration::cAudioFocusDuckLevel = "Audio.FocusDuckLevel";
+const std::string Configuration::cAudioMaxUnacked = "Audio.MaxUnacked";
+const std::string Configuration::cAudioKeepOutputsOpen = "Audio.KeepOutputsOpen";
+const std::string Configuration::cAudioPeriodSize = "Audio.PeriodSize";
+const std::string Configuration::cAudioPeriodCount = "Audio.PeriodCount";
+const std::string Configuration::cAudioInputProcessing = "Audio.InputProcessing";
+const std::string Configuration::cThreadIOServiceWorkers = "Threads.IOServiceWorkers";
+const std::string Configuration::cThreadCpuAffinity = "Threads.CpuAffinity";
+const std::string Configuration::cThreadMediaPriority = "Threads.MediaPriority";
+const std::string Configuration::cThreadServiceExecutors = "Threads.ServiceExecutors";
 
 const std::string Configuration::cBluetoothAdapterTypeKey = "Bluetooth.AdapterType";
 const std::string Configuration::cBluetoothRemoteAdapterAddressKey = "Bluetooth.RemoteAdapterAddress";
@@ -112,6 +135,7 @@ void Configuration::load()
         showCursor_ = iniConfig.get<bool>(cGeneralShowCursorKey, false);
         hideBrightnessControl_ = iniConfig.get<bool>(cGeneralHideBrightnessControlKey, false);
         hideWarning_ = iniConfig.get<bool>(cGeneralHideWarningKey, false);
+        sessionCapturePath_ = iniConfig.get<std::string>(cGeneralSessionCapturePathKey, "");
         showNetworkinfo_ = iniConfig.get<bool>(cGeneralShowNetworkinfoKey, false);
         mp3MasterPath_ = iniConfig.get<std::string>(cGeneralMp3MasterPathKey, "/media/MYMEDIA");
         mp3SubFolder_ = iniConfig.get<std::string>(cGeneralMp3SubFolderKey, "/");
@@ -129,6 +153,13 @@ void Configuration::load()
 
         omxLayerIndex_ = iniConfig.get<int32_t>(cVideoOMXLayerIndexKey, 1);
         videoMargins_ = QRect(0, 0, iniConfig.get<int32_t>(cVideoMarginWidth, 0), iniConfig.get<int32_t>(cVideoMarginHeight, 0));
+        videoMaxUnacked_ = iniConfig.get<uint32_t>(cVideoMaxUnackedKey, 1);
+        videoGstDecoder_ = iniConfig.get<std::string>(cVideoGstDecoderKey, "auto");
+        videoGstSync_ = iniConfig.get<bool>(cVideoGstSyncKey, true);
+        videoDropThreshold_ = iniConfig.get<uint32_t>(cVideoDropThresholdKey, 8);
+        videoLatencyTracing_ = iniConfig.get<bool>(cVideoLatencyTracingKey, false);
+        videoCapturePath_ = iniConfig.get<std::string>(cVideoCapturePathKey, "");
+        videoAudioSync_ = iniConfig.get<bool>(cVideoAudioSyncKey, true);
 
         enableTouchscreen_ = iniConfig.get<bool>(cInputEnableTouchscreenKey, true);
         enablePlayerControl_ = iniConfig.get<bool>(cInputEnablePlayerControlKey, false);
@@ -141,6 +172,21 @@ void Configuration::load()
         musicAudioChannelEnabled_ = iniConfig.get<bool>(cAudioMusicAudioChannelEnabled, true);
         speechAudiochannelEnabled_ = iniConfig.get<bool>(cAudioSpeechAudioChannelEnabled, true);
         audioOutputBackendType_ = static_cast<AudioOutputBackendType>(iniConfig.get<uint32_t>(cAudioOutputBackendType, static_cast<uint32_t>(AudioOutputBackendType::RTAUDIO)));
+        audioJitterBufferLatency_ = iniConfig.get<uint32_t>(cAudioJitterBufferLatency, 80);
+        audioMixerDuckLevel_ = iniConfig.get<uint32_t>(cAudioMixerDuckLevel, 30);
+        audioMixerMediaGain_ = iniConfig.get<uint32_t>(cAudioMixerMediaGain, 100);
+        audioMixerSpeechGain_ = iniConfig.get<uint32_t>(cAudioMixerSpeechGain, 100);
+        audioMixerSystemGain_ = iniConfig.get<uint32_t>(cAudioMixerSystemGain, 100);
+        audioFocusDuckLevel_ = iniConfig.get<uint32_t>(cAudioFocusDuckLevel, 30);
+        audioMaxUnacked_ = iniConfig.get<uint32_t>(cAudioMaxUnacked, 1);
+        audioKeepOutputsOpen_ = iniConfig.get<bool>(cAudioKeepOutputsOpen, true);
+        audioPeriodSize_ = iniConfig.get<uint32_t>(cAudioPeriodSize, 128);
+        audioPeriodCount_ = iniConfig.get<uint32_t>(cAudioPeriodCount, 2);
+        audioInputProcessing_ = iniConfig.get<bool>(cAudioInputProcessing, false);
+        threadIOServiceWorkers_ = iniConfig.get<uint32_t>(cThreadIOServiceWorkers, 0);
+        threadCpuAffinity_ = iniConfig.get<bool>(cThreadCpuAffinity, false);
+        threadMediaPriority_ = iniConfig.get<uint32_t>(cThreadMediaPriority, 0);
+        threadServiceExecutors_ = iniConfig.get<bool>(cThreadServiceExecutors, true);
     }
     catch(const boost::property_tree::ini_parser_error& e)
     {
@@ -164,6 +210,7 @@ void Configuration::reset()
     showCursor_ = false;
     hideBrightnessControl_ = false;
     hideWarning_ = false;
+    sessionCapturePath_ = "";
     showNetworkinfo_ = false;
     mp3MasterPath_ = "/media/MYMEDIA";
     mp3SubFolder_ = "/";
@@ -176,6 +223,13 @@ void Configuration::reset()
     screenDPI_ = 140;
     omxLayerIndex_ = 1;
     videoMargins_ = QRect(0, 0, 0, 0);
+    videoMaxUnacked_ = 1;
+    videoGstDecoder_ = "auto";
+    videoGstSync_ = true;
+    videoDropThreshold_ = 8;
+    videoLatencyTracing_ = false;
+    videoCapturePath_ = "";
+    videoAudioSync_ = true;
     enableTouchscreen_ = true;
     enablePlayerControl_ = false;
     buttonCodes_.clear();
@@ -184,6 +238,21 @@ void Configuration::reset()
     musicAudioChannelEnabled_ = true;
     speechAudiochannelEnabled_ = true;
     audioOutputBackendType_ = AudioOutputBackendType::QT;
+    audioJitterBufferLatency_ = 80;
+    audioMixerDuckLevel_ = 30;
+    audioMixerMediaGain_ = 100;
+    audioMixerSpeechGain_ = 100;
+    audioMixerSystemGain_ = 100;
+    audioFocusDuckLevel_ = 30;
+    audioMaxUnacked_ = 1;
+    audioKeepOutputsOpen_ = true;
+    audioPeriodSize_ = 128;
+    audioPeriodCount_ = 2;
+    audioInputProcessing_ = false;
+    threadIOServiceWorkers_ = 0;
+    threadCpuAffinity_ = false;
+    threadMediaPriority_ = 0;
+    threadServiceExecutors_ = true;
 }
 
 void Configuration::save()
@@ -201,6 +270,7 @@ void Configuration::save()
     iniConfig.put<bool>(cGeneralShowCursorKey, showCursor_);
     iniConfig.put<bool>(cGeneralHideBrightnessControlKey, hideBrightnessControl_);
     iniConfig.put<bool>(cGeneralHideWarningKey, hideWarning_);
+    iniConfig.put<std::string>(cGeneralSessionCapturePathKey, sessionCapturePath_);
     iniConfig.put<bool>(cGeneralShowNetworkinfoKey, showNetworkinfo_);
     iniConfig.put<std::string>(cGeneralMp3MasterPathKey, mp3MasterPath_);
     iniConfig.put<std::string>(cGeneralMp3SubFolderKey, mp3SubFolder_);
@@ -215,6 +285,13 @@ void Configuration::save()
     iniConfig.put<int32_t>(cVideoOMXLayerIndexKey, omxLayerIndex_);
     iniConfig.put<uint32_t>(cVideoMarginWidth, videoMargins_.width());
     iniConfig.put<uint32_t>(cVideoMarginHeight, videoMargins_.height());
+    iniConfig.put<uint32_t>(cVideoMaxUnackedKey, videoMaxUnacked_);
+    iniConfig.put<std::string>(cVideoGstDecoderKey, videoGstDecoder_);
+    iniConfig.put<bool>(cVideoGstSyncKey, videoGstSync_);
+    iniConfig.put<uint32_t>(cVideoDropThresholdKey, videoDropThreshold_);
+    iniConfig.put<bool>(cVideoLatencyTracingKey, videoLatencyTracing_);
+    iniConfig.put<std::string>(cVideoCapturePathKey, videoCapturePath_);
+    iniConfig.put<bool>(cVideoAudioSyncKey, videoAudioSync_);
 
     iniConfig.put<bool>(cInputEnableTouchscreenKey, enableTouchscreen_);
     iniConfig.put<bool>(cInputEnablePlayerControlKey, enablePlayerControl_);
@@ -226,6 +303,21 @@ void Configuration::save()
     iniConfig.put<bool>(cAudioMusicAudioChannelEnabled, musicAudioChannelEnabled_);
     iniConfig.put<bool>(cAudioSpeechAudioChannelEnabled, speechAudiochannelEnabled_);
     iniConfig.put<uint32_t>(cAudioOutputBackendType, static_cast<uint32_t>(audioOutputBackendType_));
+    iniConfig.put<uint32_t>(cAudioJitterBufferLatency, audioJitterBufferLatency_);
+    iniConfig.put<uint32_t>(cAudioMixerDuckLevel, audioMixerDuckLevel_);
+    iniConfig.put<uint32_t>(cAudioMixerMediaGain, audioMixerMediaGain_);
+    iniConfig.put<uint32_t>(cAudioMixerSpeechGain, audioMixerSpeechGain_);
+    iniConfig.put<uint32_t>(cAudioMixerSystemGain, audioMixerSystemGain_);
+    iniConfig.put<uint32_t>(cAudioFocusDuckLevel, audioFocusDuckLevel_);
+    iniConfig.put<uint32_t>(cAudioMaxUnacked, audioMaxUnacked_);
+    iniConfig.put<bool>(cAudioKeepOutputsOpen, audioKeepOutputsOpen_);
+    iniConfig.put<uint32_t>(cAudioPeriodSize, audioPeriodSize_);
+    iniConfig.put<uint32_t>(cAudioPeriodCount, audioPeriodCount_);
+    iniConfig.put<bool>(cAudioInputProcessing, audioInputProcessing_);
+    iniConfig.put<uint32_t>(cThreadIOServiceWorkers, threadIOServiceWorkers_);
+    iniConfig.put<bool>(cThreadCpuAffinity, threadCpuAffinity_);
+    iniConfig.put<uint32_t>(cThreadMediaPriority, threadMediaPriority_);
+    iniConfig.put<bool>(cThreadServiceExecutors, threadServiceExecutors_);
     boost::property_tree::ini_parser::write_ini(cConfigFileName, iniConfig);
 }
 
@@ -358,6 +450,16 @@ bool Configuration::hideWarning() const
     return hideWarning_;
 }
 
+std::string Configuration::getSessionCapturePath() const
+{
+    return sessionCapturePath_;
+}
+
+void Configuration::setSessionCapturePath(const std::string& value)
+{
+    sessionCapturePath_ = value;
+}
+
 void Configuration::showNetworkinfo(bool value)
 {
     showNetworkinfo_ = value;
@@ -478,6 +580,76 @@ QRect Configuration::getVideoMargins() const
     return videoMargins_;
 }
 
+uint32_t Configuration::getVideoMaxUnacked() const
+{
+    return videoMaxUnacked_;
+}
+
+void Configuration::setVideoMaxUnacked(uint32_t value)
+{
+    videoMaxUnacked_ = value;
+}
+
+std::string Configuration::getVideoGstDecoder() const
+{
+    return videoGstDecoder_;
+}
+
+void Configuration::setVideoGstDecoder(const std::string& value)
+{
+    videoGstDecoder_ = value;
+}
+
+bool Configuration::getVideoGstSync() const
+{
+    return videoGstSync_;
+}
+
+void Configuration::setVideoGstSync(bool value)
+{
+    videoGstSync_ = value;
+}
+
+uint32_t Configuration::getVideoDropThreshold() const
+{
+    return videoDropThreshold_;
+}
+
+void Configuration::setVideoDropThreshold(uint32_t value)
+{
+    videoDropThreshold_ = value;
+}
+
+bool Configuration::getVideoLatencyTracing() const
+{
+    return videoLatencyTracing_;
+}
+
+void Configuration::setVideoLatencyTracing(bool value)
+{
+    videoLatencyTracing_ = value;
+}
+
+std::string Configuration::getVideoCapturePath() const
+{
+    return videoCapturePath_;
+}
+
+void Configuration::setVideoCapturePath(const std::string& value)
+{
+    videoCapturePath_ = value;
+}
+
+bool Configuration::getVideoAudioSync() const
+{
+    return videoAudioSync_;
+}
+
+void Configuration::setVideoAudioSync(bool value)
+{
+    videoAudioSync_ = value;
+}
+
 bool Configuration::getTouchscreenEnabled() const
 {
     return enableTouchscreen_;
@@ -558,6 +730,156 @@ void Configuration::setAudioOutputBackendType(AudioOutputBackendType value)
     audioOutputBackendType_ = value;
 }
 
+uint32_t Configuration::getAudioJitterBufferLatency() const
+{
+    return audioJitterBufferLatency_;
+}
+
+void Configuration::setAudioJitterBufferLatency(uint32_t value)
+{
+    audioJitterBufferLatency_ = value;
+}
+
+uint32_t Configuration::getAudioMixerDuckLevel() const
+{
+    return audioMixerDuckLevel_;
+}
+
+void Configuration::setAudioMixerDuckLevel(uint32_t value)
+{
+    audioMixerDuckLevel_ = value;
+}
+
+uint32_t Configuration::getAudioMixerMediaGain() const
+{
+    return audioMixerMediaGain_;
+}
+
+void Configuration::setAudioMixerMediaGain(uint32_t value)
+{
+    audioMixerMediaGain_ = value;
+}
+
+uint32_t Configuration::getAudioMixerSpeechGain() const
+{
+    return audioMixerSpeechGain_;
+}
+
+void Configuration::setAudioMixerSpeechGain(uint32_t value)
+{
+    audioMixerSpeechGain_ = value;
+}
+
+uint32_t Configuration::getAudioMixerSystemGain() const
+{
+    return audioMixerSystemGain_;
+}
+
+void Configuration::setAudioMixerSystemGain(uint32_t value)
+{
+    audioMixerSystemGain_ = value;
+}
+
+uint32_t Configuration::getAudioFocusDuckLevel() const
+{
+    return audioFocusDuckLevel_;
+}
+
+void Configuration::setAudioFocusDuckLevel(uint32_t value)
+{
+    audioFocusDuckLevel_ = value;
+}
+
+uint32_t Configuration::getAudioMaxUnacked() const
+{
+    return audioMaxUnacked_;
+}
+
+void Configuration::setAudioMaxUnacked(uint32_t value)
+{
+    audioMaxUnacked_ = value;
+}
+
+bool Configuration::getAudioKeepOutputsOpen() const
+{
+    return audioKeepOutputsOpen_;
+}
+
+void Configuration::setAudioKeepOutputsOpen(bool value)
+{
+    audioKeepOutputsOpen_ = value;
+}
+
+uint32_t Configuration::getAudioPeriodSize() const
+{
+    return audioPeriodSize_;
+}
+
+void Configuration::setAudioPeriodSize(uint32_t value)
+{
+    audioPeriodSize_ = value;
+}
+
+uint32_t Configuration::getAudioPeriodCount() const
+{
+    return audioPeriodCount_;
+}
+
+void Configuration::setAudioPeriodCount(uint32_t value)
+{
+    audioPeriodCount_ = value;
+}
+
+bool Configuration::getAudioInputProcessing() const
+{
+    return audioInputProcessing_;
+}
+
+void Configuration::setAudioInputProcessing(bool value)
+{
+    audioInputProcessing_ = value;
+}
+
+uint32_t Configuration::getThreadIOServiceWorkers() const
+{
+    return threadIOServiceWorkers_;
+}
+
+void Configuration::setThreadIOServiceWorkers(uint32_t value)
+{
+    threadIOServiceWorkers_ = value;
+}
+
+bool Configuration::getThreadCpuAffinity() const
+{
+    return threadCpuAffinity_;
+}
+
+void Configuration::setThreadCpuAffinity(bool value)
+{
+    threadCpuAffinity_ = value;
+}
+
+uint32_t Configuration::getThreadMediaPriority() const
+{
+    return threadMediaPriority_;
+}
+
+void Configuration::setThreadMediaPriority(uint32_t value)
+{
+    threadMediaPriority_ = value;
+}
+
+bool Configuration::getThreadServiceExecutors() const
+{
+    return threadServiceExecutors_;
+}
+
+void Configuration::setThreadServiceExecutors(bool value)
+{
+    threadServiceExecutors_ = value;
+}
+
 QString Configuration::getCSValue(QString searchString) const
 {
     using namespace std;
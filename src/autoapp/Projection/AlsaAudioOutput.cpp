@@ -0,0 +1,374 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifdef USE_ALSA
+
+#include <algorithm>
+#include <cstring>
+#include <pthread.h>
+#include <f1x/openauto/autoapp/Projection/AlsaAudioOutput.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Rates probed when the phone asks what the device can play natively.
+static const unsigned int cProbedSampleRates[] = {8000, 11025, 16000, 22050, 32000, 44100, 48000};
+// Below whatever the audio server runs at, above ordinary threads.
+static constexpr int cThreadPriority = 70;
+
+AlsaAudioOutput::AlsaAudioOutput(std::string deviceName, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency,
+                                 uint32_t periodSize, uint32_t periodCount)
+    : deviceName_(std::move(deviceName))
+    , requestedPeriodSize_(std::max<uint32_t>(periodSize, 16))
+    , requestedPeriodCount_(std::max<uint32_t>(periodCount, 2))
+    , channelCount_(channelCount)
+    , sampleSize_(sampleSize)
+    , sampleRate_(sampleRate)
+    , audioBuffer_(channelCount, sampleSize, sampleRate, targetLatency)
+    , pcm_(nullptr)
+    , periodSize_(0)
+    , bufferSize_(0)
+    , running_(false)
+    , playing_(false)
+    , xruns_(0)
+{
+
+}
+
+AlsaAudioOutput::~AlsaAudioOutput()
+{
+    this->close();
+}
+
+bool AlsaAudioOutput::open()
+{
+    if(pcm_ != nullptr)
+    {
+        return true;
+    }
+
+    snd_pcm_t* pcm = nullptr;
+    const auto result = snd_pcm_open(&pcm, deviceName_.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+
+    if(result < 0)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] Failed to open device " << deviceName_ << ", what: " << snd_strerror(result);
+        return false;
+    }
+
+    if(!this->configure(pcm))
+    {
+        snd_pcm_close(pcm);
+        return false;
+    }
+
+    pcm_ = pcm;
+    period_.assign(periodSize_ * channelCount_ * (sampleSize_ / 8), 0);
+
+    const auto latency = static_cast<uint64_t>(bufferSize_) * 1000000 / sampleRate_;
+    audioBuffer_.setOutputLatency(latency);
+
+    if(!audioBuffer_.lockMemory())
+    {
+        OPENAUTO_LOG(warning) << "[AlsaAudioOutput] Failed to lock audio buffer in memory, playback may glitch under memory pressure.";
+    }
+
+    OPENAUTO_LOG(info) << "[AlsaAudioOutput] Opened device " << deviceName_
+                       << ", sample rate: " << sampleRate_
+                       << ", period size: " << periodSize_
+                       << ", periods: " << bufferSize_ / periodSize_
+                       << ", latency: " << latency << "us";
+
+    running_ = true;
+    playing_ = false;
+    thread_ = std::thread(&AlsaAudioOutput::run, this);
+
+    return audioBuffer_.open(QIODevice::ReadWrite);
+}
+
+void AlsaAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    audioBuffer_.push(reinterpret_cast<const char*>(buffer.cdata), buffer.size, timestamp);
+}
+
+void AlsaAudioOutput::start()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        playing_ = true;
+    }
+
+    playingChanged_.notify_one();
+}
+
+void AlsaAudioOutput::stop()
+{
+    this->close();
+    audioBuffer_.flush();
+}
+
+void AlsaAudioOutput::suspend()
+{
+    audioBuffer_.endOfStream();
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    playing_ = false;
+}
+
+void AlsaAudioOutput::flush()
+{
+    audioBuffer_.requestFlush();
+}
+
+void AlsaAudioOutput::setGain(float gain)
+{
+    audioBuffer_.setGain(gain);
+}
+
+uint32_t AlsaAudioOutput::getSampleSize() const
+{
+    return sampleSize_;
+}
+
+uint32_t AlsaAudioOutput::getChannelCount() const
+{
+    return channelCount_;
+}
+
+uint32_t AlsaAudioOutput::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+std::vector<AudioFormat> AlsaAudioOutput::getSupportedFormats() const
+{
+    AudioFormat current;
+    current.sampleRate = sampleRate_;
+    current.sampleSize = sampleSize_;
+    current.channelCount = channelCount_;
+
+    std::vector<AudioFormat> formats{current};
+
+    // A second handle, so that this works while the stream is open too; if
+    // the device can't be shared, only the current format is offered.
+    snd_pcm_t* pcm = nullptr;
+    if(snd_pcm_open(&pcm, deviceName_.c_str(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK) < 0)
+    {
+        return formats;
+    }
+
+    snd_pcm_hw_params_t* hwParams;
+    snd_pcm_hw_params_alloca(&hwParams);
+
+    // Without resampling in the plugin chain, only what the device plays
+    // natively passes.
+    if(snd_pcm_hw_params_any(pcm, hwParams) >= 0
+       && snd_pcm_hw_params_set_rate_resample(pcm, hwParams, 0) >= 0
+       && snd_pcm_hw_params_set_format(pcm, hwParams, SND_PCM_FORMAT_S16_LE) >= 0
+       && snd_pcm_hw_params_set_channels(pcm, hwParams, channelCount_) >= 0)
+    {
+        for(const auto sampleRate : cProbedSampleRates)
+        {
+            if(sampleRate != sampleRate_ && snd_pcm_hw_params_test_rate(pcm, hwParams, sampleRate, 0) == 0)
+            {
+                AudioFormat format = current;
+                format.sampleRate = sampleRate;
+                formats.push_back(format);
+            }
+        }
+    }
+
+    snd_pcm_close(pcm);
+    return formats;
+}
+
+bool AlsaAudioOutput::setFormat(const AudioFormat& format)
+{
+    // The stream is always opened as S16_LE.
+    if(pcm_ != nullptr || format.sampleSize != 16)
+    {
+        return false;
+    }
+
+    channelCount_ = format.channelCount;
+    sampleSize_ = format.sampleSize;
+    sampleRate_ = format.sampleRate;
+    audioBuffer_.setFormat(channelCount_, sampleSize_, sampleRate_);
+    return true;
+}
+
+AudioBufferStats AlsaAudioOutput::getBufferStats() const
+{
+    auto stats = audioBuffer_.getStats();
+    // A device underrun is a buffer underrun as far as the listener goes.
+    stats.underruns += xruns_;
+    return stats;
+}
+
+MediaClock::Pointer AlsaAudioOutput::getMediaClock() const
+{
+    return audioBuffer_.getMediaClock();
+}
+
+bool AlsaAudioOutput::configure(snd_pcm_t* pcm)
+{
+    snd_pcm_hw_params_t* hwParams;
+    snd_pcm_hw_params_alloca(&hwParams);
+    snd_pcm_sw_params_t* swParams;
+    snd_pcm_sw_params_alloca(&swParams);
+
+    unsigned int sampleRate = sampleRate_;
+    snd_pcm_uframes_t periodSize = requestedPeriodSize_;
+    unsigned int periodCount = requestedPeriodCount_;
+
+    int result = snd_pcm_hw_params_any(pcm, hwParams);
+    result = result < 0 ? result : snd_pcm_hw_params_set_access(pcm, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED);
+    result = result < 0 ? result : snd_pcm_hw_params_set_format(pcm, hwParams, SND_PCM_FORMAT_S16_LE);
+    result = result < 0 ? result : snd_pcm_hw_params_set_channels(pcm, hwParams, channelCount_);
+    result = result < 0 ? result : snd_pcm_hw_params_set_rate_near(pcm, hwParams, &sampleRate, nullptr);
+    result = result < 0 ? result : snd_pcm_hw_params_set_period_size_near(pcm, hwParams, &periodSize, nullptr);
+    result = result < 0 ? result : snd_pcm_hw_params_set_periods_near(pcm, hwParams, &periodCount, nullptr);
+    result = result < 0 ? result : snd_pcm_hw_params(pcm, hwParams);
+
+    if(result < 0)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] Failed to set hardware parameters, what: " << snd_strerror(result);
+        return false;
+    }
+
+    if(sampleRate != sampleRate_)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] Device does not support sample rate " << sampleRate_ << ", nearest: " << sampleRate;
+        return false;
+    }
+
+    snd_pcm_hw_params_get_period_size(hwParams, &periodSize_, nullptr);
+    snd_pcm_hw_params_get_buffer_size(hwParams, &bufferSize_);
+
+    // Playback starts once the whole buffer is queued and the playback thread
+    // is woken for every period that frees up.
+    result = snd_pcm_sw_params_current(pcm, swParams);
+    result = result < 0 ? result : snd_pcm_sw_params_set_start_threshold(pcm, swParams, bufferSize_);
+    result = result < 0 ? result : snd_pcm_sw_params_set_avail_min(pcm, swParams, periodSize_);
+    result = result < 0 ? result : snd_pcm_sw_params(pcm, swParams);
+
+    if(result < 0)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] Failed to set software parameters, what: " << snd_strerror(result);
+        return false;
+    }
+
+    return true;
+}
+
+void AlsaAudioOutput::close()
+{
+    if(pcm_ == nullptr)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        running_ = false;
+        playing_ = false;
+    }
+
+    playingChanged_.notify_one();
+    thread_.join();
+
+    snd_pcm_drop(pcm_);
+    snd_pcm_close(pcm_);
+    pcm_ = nullptr;
+    audioBuffer_.setOutputLatency(0);
+}
+
+// Sole consumer of audioBuffer_ while the device is open.
+void AlsaAudioOutput::run()
+{
+    this->promoteThread();
+
+    const auto frameSize = channelCount_ * (sampleSize_ / 8);
+
+    while(running_)
+    {
+        // The lock is only taken to sleep while suspended, never per period.
+        if(!playing_)
+        {
+            // Silence right away rather than after the queued periods.
+            snd_pcm_drop(pcm_);
+            snd_pcm_prepare(pcm_);
+
+            std::unique_lock<decltype(mutex_)> lock(mutex_);
+            playingChanged_.wait(lock, [this]() { return playing_ || !running_; });
+            continue;
+        }
+
+        audioBuffer_.pull(period_.data(), period_.size());
+
+        snd_pcm_uframes_t written = 0;
+        while(written < periodSize_)
+        {
+            auto result = snd_pcm_writei(pcm_, period_.data() + written * frameSize, periodSize_ - written);
+
+            if(result < 0)
+            {
+                ++xruns_;
+                result = snd_pcm_recover(pcm_, static_cast<int>(result), 1);
+
+                if(result < 0)
+                {
+                    // Nothing more to do until the stream is restarted.
+                    OPENAUTO_LOG(error) << "[AlsaAudioOutput] Failed to recover from " << snd_strerror(static_cast<int>(result));
+                    playing_ = false;
+                    break;
+                }
+
+                continue;
+            }
+
+            written += static_cast<snd_pcm_uframes_t>(result);
+        }
+    }
+}
+
+void AlsaAudioOutput::promoteThread()
+{
+    sched_param param{};
+    param.sched_priority = std::min(cThreadPriority, sched_get_priority_max(SCHED_FIFO));
+
+    const auto result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if(result != 0)
+    {
+        OPENAUTO_LOG(warning) << "[AlsaAudioOutput] Failed to make the playback thread real-time, what: " << strerror(result);
+    }
+}
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/AudioCallbackMonitor.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+AudioCallbackMonitor::AudioCallbackMonitor(uint32_t budget)
+    : budget_(budget)
+    , overruns_(0)
+    , maxLoad_(0)
+{
+
+}
+
+AudioCallbackMonitor::TimePoint AudioCallbackMonitor::now()
+{
+    return std::chrono::steady_clock::now();
+}
+
+bool AudioCallbackMonitor::record(const TimePoint& start, uint64_t period)
+{
+    if(period == 0)
+    {
+        return false;
+    }
+
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now() - start).count();
+    const auto load = static_cast<uint32_t>(static_cast<uint64_t>(duration) * 100 / period);
+
+    const bool overrun = load > budget_;
+    if(overrun)
+    {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Single writer, so a plain compare is enough.
+    if(load > maxLoad_.load(std::memory_order_relaxed))
+    {
+        maxLoad_.store(load, std::memory_order_relaxed);
+    }
+
+    return overrun;
+}
+
+uint64_t AudioCallbackMonitor::getOverruns() const
+{
+    return overruns_.load(std::memory_order_relaxed);
+}
+
+uint32_t AudioCallbackMonitor::getMaxLoad() const
+{
+    return maxLoad_.load(std::memory_order_relaxed);
+}
+
+}
+}
+}
+}
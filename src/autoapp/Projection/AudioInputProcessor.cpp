@@ -0,0 +1,210 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <f1x/openauto/autoapp/Projection/AudioInputProcessor.hpp>
+#include <f1x/openauto/autoapp/Projection/SimdKernels.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Echo filter length in samples; 128 ms at 16 kHz.
+static constexpr size_t cFilterLength = 2048;
+// The filter is never shortened below this.
+static constexpr size_t cMinFilterLength = 256;
+// NLMS step size, and the regularisation that keeps it sane when the
+// reference is close to silent.
+static constexpr float cStepSize = 0.2f;
+static constexpr float cRegularisation = 1e4f;
+// Share of a frame's duration processing it may take, in percent.
+static constexpr uint32_t cProcessingBudget = 30;
+// Noise floor rise per frame while the signal stays above it, roughly 1 dB/s.
+static constexpr float cNoiseFloorRise = 1.0023f;
+// Lowest gain noise suppression applies, -20 dB.
+static constexpr float cMinGain = 0.1f;
+
+AudioInputProcessor::AudioInputProcessor(uint32_t sampleRate, EchoReference::Pointer echoReference)
+    : sampleRate_(sampleRate)
+    , frameSize_(std::max<size_t>(1, sampleRate / 100))
+    , echoReference_(std::move(echoReference))
+    , echoCancellation_(false)
+    , noiseSuppression_(false)
+    , budgetMonitor_(cProcessingBudget)
+    , frame_(frameSize_, 0.0f)
+    , coefficients_(cFilterLength, 0.0f)
+    , history_(cFilterLength + frameSize_, 0.0f)
+    , filterLength_(cFilterLength)
+    , noiseFloor_(0.0f)
+    , gain_(1.0f)
+{
+
+}
+
+void AudioInputProcessor::configure(bool echoCancellation, bool noiseSuppression)
+{
+    echoCancellation_ = echoCancellation && echoReference_ != nullptr;
+    noiseSuppression_ = noiseSuppression;
+
+    std::fill(coefficients_.begin(), coefficients_.end(), 0.0f);
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    filterLength_ = cFilterLength;
+    noiseFloor_ = 0.0f;
+    gain_ = 1.0f;
+
+    // Whatever played before the microphone opened is of no use; from here
+    // on the reference only ever lags the microphone by the echo path.
+    if(echoReference_ != nullptr)
+    {
+        echoReference_->trim(0);
+    }
+}
+
+bool AudioInputProcessor::isEnabled() const
+{
+    return echoCancellation_ || noiseSuppression_;
+}
+
+void AudioInputProcessor::process(aasdk::common::Data& data)
+{
+    auto samples = reinterpret_cast<int16_t*>(data.data());
+    auto remaining = data.size() / sizeof(int16_t);
+
+    while(remaining > 0)
+    {
+        const auto count = std::min(remaining, frameSize_);
+        const auto start = AudioCallbackMonitor::now();
+
+        simd::int16ToFloat(samples, frame_.data(), count);
+        this->processFrame(frame_.data(), count);
+        simd::floatToInt16(frame_.data(), samples, count);
+
+        if(budgetMonitor_.record(start, static_cast<uint64_t>(count) * 1000000 / sampleRate_))
+        {
+            this->shortenFilter();
+        }
+
+        samples += count;
+        remaining -= count;
+    }
+}
+
+uint64_t AudioInputProcessor::getBudgetOverruns() const
+{
+    return budgetMonitor_.getOverruns();
+}
+
+uint32_t AudioInputProcessor::getMaxLoad() const
+{
+    return budgetMonitor_.getMaxLoad();
+}
+
+void AudioInputProcessor::processFrame(float* samples, size_t count)
+{
+    if(echoCancellation_)
+    {
+        this->cancelEcho(samples, count);
+    }
+
+    if(noiseSuppression_)
+    {
+        this->suppressNoise(samples, count);
+    }
+}
+
+void AudioInputProcessor::cancelEcho(float* samples, size_t count)
+{
+    auto reference = &history_[cFilterLength];
+    const auto received = echoReference_->read(reference, count);
+    std::fill(reference + received, reference + count, 0.0f);
+
+    // Window of the first sample, minus its newest reference sample.
+    const float* window = &history_[cFilterLength - filterLength_];
+    float energy = simd::dotProduct(window, window, filterLength_);
+
+    // Nothing playing and nothing left in the filter's reach: no echo.
+    if(energy > 0.0f || received > 0)
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            const auto incoming = history_[cFilterLength + i];
+            const auto outgoing = history_[cFilterLength + i - filterLength_];
+            energy = std::max(0.0f, energy + incoming * incoming - outgoing * outgoing);
+
+            const float* x = &history_[cFilterLength + i + 1 - filterLength_];
+            const auto error = samples[i] - simd::dotProduct(coefficients_.data(), x, filterLength_);
+            simd::mixInto(coefficients_.data(), x, cStepSize * error / (energy + cRegularisation), filterLength_);
+            samples[i] = error;
+        }
+    }
+
+    std::copy(history_.begin() + count, history_.begin() + count + cFilterLength, history_.begin());
+}
+
+void AudioInputProcessor::suppressNoise(float* samples, size_t count)
+{
+    const auto energy = simd::dotProduct(samples, samples, count) / count + 1.0f;
+
+    noiseFloor_ = noiseFloor_ == 0.0f || energy < noiseFloor_ ? energy : noiseFloor_ * cNoiseFloorRise;
+
+    // Amplitude gain of a power subtraction, ramped across the frame so that
+    // it doesn't step at the frame boundary.
+    const auto target = std::max(cMinGain, std::sqrt(std::max(0.0f, 1.0f - noiseFloor_ / energy)));
+    const auto step = (target - gain_) / count;
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        gain_ += step;
+        samples[i] *= gain_;
+    }
+
+    gain_ = target;
+}
+
+void AudioInputProcessor::shortenFilter()
+{
+    if(filterLength_ <= cMinFilterLength)
+    {
+        OPENAUTO_LOG(warning) << "[AudioInputProcessor] frame over budget at the shortest echo filter"
+                              << ", load: " << budgetMonitor_.getMaxLoad() << "%"
+                              << ", budget: " << cProcessingBudget << "%";
+        return;
+    }
+
+    // The oldest coefficients go, so the newest ones keep lining up with
+    // the newest reference samples.
+    const auto length = std::max(cMinFilterLength, filterLength_ * 3 / 4);
+    std::copy(coefficients_.begin() + (filterLength_ - length), coefficients_.begin() + filterLength_, coefficients_.begin());
+    filterLength_ = length;
+
+    OPENAUTO_LOG(warning) << "[AudioInputProcessor] frame over budget, echo filter shortened to " << filterLength_ << " taps"
+                          << ", budget: " << cProcessingBudget << "%";
+}
+
+}
+}
+}
+}
@@ -0,0 +1,382 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Upper bound for the adaptive target, in milliseconds.
+static constexpr uint32_t cMaxTargetLatency = 500;
+// Amount the target moves by on every adjustment, in milliseconds.
+static constexpr uint32_t cAdaptStep = 20;
+// Underrun-free playback needed before the target is lowered again.
+static constexpr uint32_t cStablePeriod = 10000;
+// Time a gain change takes to go from silence to full level, in milliseconds.
+static constexpr uint32_t cGainRampTime = 50;
+// Timestamped packets that can be queued at once.
+static constexpr size_t cMaxTimestampMarks = 256;
+
+AudioJitterBuffer::AudioJitterBuffer(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency)
+    : targetLatency_(targetLatency)
+    , data_(0)
+    , marks_(cMaxTimestampMarks * sizeof(TimestampMark))
+    , clock_(std::make_shared<MediaClock>())
+    , priming_(true)
+    , drained_(false)
+    , drainPosition_(0)
+    , stableBytes_(0)
+    , currentGain_(1.0f)
+    , hasCurrentMark_(false)
+    , hasNextMark_(false)
+    , targetDepth_(0)
+    , flushPosition_(0)
+    , flushRequested_(false)
+    , endPosition_(0)
+    , hasEndPosition_(false)
+    , targetGain_(1.0f)
+    , outputLatency_(0)
+    , underruns_(0)
+    , overruns_(0)
+{
+    this->setFormat(channelCount, sampleSize, sampleRate);
+}
+
+bool AudioJitterBuffer::isSequential() const
+{
+    return true;
+}
+
+bool AudioJitterBuffer::open(OpenMode mode)
+{
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+qint64 AudioJitterBuffer::bytesAvailable() const
+{
+    return QIODevice::bytesAvailable() + data_.size();
+}
+
+size_t AudioJitterBuffer::push(const char* data, size_t len, uint64_t timestamp)
+{
+    // The capacity is a multiple of the mark size, so a mark either fits
+    // whole or not at all.
+    if(timestamp != 0 && marks_.capacity() - marks_.size() >= sizeof(TimestampMark))
+    {
+        const TimestampMark mark{data_.writePosition(), timestamp};
+        marks_.write(reinterpret_cast<const char*>(&mark), sizeof(mark));
+    }
+
+    const auto written = data_.write(data, len);
+
+    if(written < len)
+    {
+        ++overruns_;
+    }
+
+    return written;
+}
+
+size_t AudioJitterBuffer::pull(char* data, size_t len)
+{
+    const auto start = AudioCallbackMonitor::now();
+    this->applyFlushRequest();
+    this->doPull(data, len);
+    callbackMonitor_.record(start, bytesToMicroseconds(len));
+    return len;
+}
+
+void AudioJitterBuffer::doPull(char* data, size_t len)
+{
+    const auto depth = data_.size();
+
+    if(drained_ && depth > 0)
+    {
+        this->onRefill();
+    }
+
+    const auto targetDepth = targetDepth_.load(std::memory_order_relaxed);
+
+    if(priming_)
+    {
+        if(depth < targetDepth)
+        {
+            memset(data, 0, len);
+            // Nothing to ramp over, so start the stream at the requested level.
+            currentGain_ = targetGain_.load(std::memory_order_relaxed);
+            clock_->invalidate();
+            return;
+        }
+
+        priming_ = false;
+    }
+
+    // The phone bursts now and then; rather than carrying the extra latency
+    // for the rest of the stream, drop back to the target in one go.
+    if(depth > targetDepth * 2 + len)
+    {
+        const auto excess = depth - targetDepth;
+        data_.skip(excess - excess % frameSize_);
+        ++overruns_;
+    }
+
+    const auto position = data_.readPosition();
+    const auto read = data_.read(data, len);
+    this->updateClock(position, len);
+
+    if(read < len)
+    {
+        memset(data + read, 0, len - read);
+        priming_ = true;
+        stableBytes_ = 0;
+        drained_ = true;
+        drainPosition_ = data_.readPosition();
+    }
+    else if((stableBytes_ += len) >= durationToBytes(cStablePeriod))
+    {
+        stableBytes_ = 0;
+        targetDepth_.store(std::max(targetDepth - std::min(targetDepth, adaptStep_), minTargetDepth_), std::memory_order_relaxed);
+    }
+
+    this->applyGain(data, len);
+}
+
+// Audio came back after the buffer ran dry. Unless the producer had ended the
+// stream right where playback stopped, it fell behind: count an underrun and
+// buffer more from now on.
+void AudioJitterBuffer::onRefill()
+{
+    drained_ = false;
+
+    const bool streamEnded = hasEndPosition_.load(std::memory_order_acquire)
+        && endPosition_.load(std::memory_order_relaxed) == drainPosition_;
+
+    const auto targetDepth = targetDepth_.load(std::memory_order_relaxed);
+
+    if(streamEnded)
+    {
+        targetDepth_.store(minTargetDepth_, std::memory_order_relaxed);
+    }
+    else
+    {
+        ++underruns_;
+        targetDepth_.store(std::min(targetDepth + adaptStep_, maxTargetDepth_), std::memory_order_relaxed);
+    }
+}
+
+void AudioJitterBuffer::endOfStream()
+{
+    endPosition_.store(data_.writePosition(), std::memory_order_relaxed);
+    hasEndPosition_.store(true, std::memory_order_release);
+}
+
+void AudioJitterBuffer::flush()
+{
+    data_.clear();
+    marks_.clear();
+    hasCurrentMark_ = false;
+    hasNextMark_ = false;
+    clock_->invalidate();
+    priming_ = true;
+    drained_ = false;
+    stableBytes_ = 0;
+    targetDepth_.store(minTargetDepth_, std::memory_order_relaxed);
+}
+
+void AudioJitterBuffer::requestFlush()
+{
+    flushPosition_.store(data_.writePosition(), std::memory_order_relaxed);
+    flushRequested_.store(true, std::memory_order_release);
+}
+
+void AudioJitterBuffer::setOutputLatency(uint64_t latency)
+{
+    outputLatency_.store(latency, std::memory_order_relaxed);
+}
+
+bool AudioJitterBuffer::lockMemory()
+{
+    return data_.lock() && marks_.lock();
+}
+
+void AudioJitterBuffer::applyFlushRequest()
+{
+    if(!flushRequested_.exchange(false, std::memory_order_acquire))
+    {
+        return;
+    }
+
+    // Only what was queued when the flush was requested goes; audio pushed
+    // since then belongs to the next stream. Positions wrap, hence the
+    // signed difference.
+    const auto pending = static_cast<ptrdiff_t>(flushPosition_.load(std::memory_order_relaxed) - data_.readPosition());
+
+    if(pending > 0)
+    {
+        data_.skip(static_cast<size_t>(pending));
+    }
+
+    hasCurrentMark_ = false;
+    clock_->invalidate();
+    priming_ = true;
+    drained_ = false;
+    stableBytes_ = 0;
+    targetDepth_.store(minTargetDepth_, std::memory_order_relaxed);
+}
+
+void AudioJitterBuffer::setGain(float gain)
+{
+    targetGain_.store(std::min(std::max(gain, 0.0f), 1.0f), std::memory_order_relaxed);
+}
+
+void AudioJitterBuffer::setFormat(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+{
+    frameSize_ = std::max<size_t>(1, channelCount * (sampleSize / 8));
+    sampleSize_ = sampleSize;
+    sampleRate_ = sampleRate;
+    minTargetDepth_ = durationToBytes(targetLatency_);
+    maxTargetDepth_ = durationToBytes(std::max(targetLatency_, cMaxTargetLatency));
+    adaptStep_ = durationToBytes(cAdaptStep);
+    gainStep_ = 1.0f / std::max<uint32_t>(1, sampleRate * cGainRampTime / 1000);
+
+    data_.reset(maxTargetDepth_ * 2 + durationToBytes(cMaxTargetLatency));
+    hasEndPosition_ = false;
+    this->flush();
+}
+
+AudioBufferStats AudioJitterBuffer::getStats() const
+{
+    AudioBufferStats stats;
+    stats.underruns = underruns_;
+    stats.overruns = overruns_;
+    stats.depth = bytesToDuration(data_.size());
+    stats.targetLatency = bytesToDuration(targetDepth_);
+    stats.outputLatency = static_cast<uint32_t>(outputLatency_ / 1000);
+    stats.callbackOverruns = callbackMonitor_.getOverruns();
+    stats.maxCallbackLoad = callbackMonitor_.getMaxLoad();
+    return stats;
+}
+
+const MediaClock::Pointer& AudioJitterBuffer::getMediaClock() const
+{
+    return clock_;
+}
+
+qint64 AudioJitterBuffer::readData(char *data, qint64 maxlen)
+{
+    return this->pull(data, maxlen - maxlen % frameSize_);
+}
+
+qint64 AudioJitterBuffer::writeData(const char *data, qint64 len)
+{
+    return this->push(data, len);
+}
+
+size_t AudioJitterBuffer::durationToBytes(uint32_t duration) const
+{
+    return static_cast<size_t>(sampleRate_) * duration / 1000 * frameSize_;
+}
+
+uint32_t AudioJitterBuffer::bytesToDuration(size_t bytes) const
+{
+    return sampleRate_ == 0 ? 0 : static_cast<uint32_t>(bytes / frameSize_ * 1000 / sampleRate_);
+}
+
+uint64_t AudioJitterBuffer::bytesToMicroseconds(size_t bytes) const
+{
+    return sampleRate_ == 0 ? 0 : static_cast<uint64_t>(bytes / frameSize_) * 1000000 / sampleRate_;
+}
+
+void AudioJitterBuffer::updateClock(size_t position, size_t len)
+{
+    // Positions wrap, so they are only ever compared through their difference.
+    while(true)
+    {
+        if(!hasNextMark_)
+        {
+            hasNextMark_ = marks_.read(reinterpret_cast<char*>(&nextMark_), sizeof(nextMark_)) == sizeof(nextMark_);
+        }
+
+        if(!hasNextMark_ || static_cast<ptrdiff_t>(nextMark_.position - position) > 0)
+        {
+            break;
+        }
+
+        currentMark_ = nextMark_;
+        hasCurrentMark_ = true;
+        hasNextMark_ = false;
+    }
+
+    if(hasCurrentMark_)
+    {
+        const auto outputLatency = outputLatency_.load(std::memory_order_relaxed);
+        const auto delay = outputLatency != 0 ? outputLatency : bytesToMicroseconds(len);
+        clock_->update(currentMark_.timestamp + bytesToMicroseconds(position - currentMark_.position), delay);
+    }
+}
+
+void AudioJitterBuffer::applyGain(char* data, size_t len)
+{
+    const auto targetGain = targetGain_.load(std::memory_order_relaxed);
+
+    if(currentGain_ == targetGain && targetGain == 1.0f)
+    {
+        return;
+    }
+
+    if(sampleSize_ != 16)
+    {
+        currentGain_ = targetGain;
+        return;
+    }
+
+    auto* samples = reinterpret_cast<int16_t*>(data);
+    const size_t channelCount = frameSize_ / sizeof(int16_t);
+    const size_t frameCount = len / frameSize_;
+
+    for(size_t frame = 0; frame < frameCount; ++frame)
+    {
+        if(currentGain_ < targetGain)
+        {
+            currentGain_ = std::min(currentGain_ + gainStep_, targetGain);
+        }
+        else if(currentGain_ > targetGain)
+        {
+            currentGain_ = std::max(currentGain_ - gainStep_, targetGain);
+        }
+
+        for(size_t channel = 0; channel < channelCount; ++channel, ++samples)
+        {
+            *samples = static_cast<int16_t>(*samples * currentGain_);
+        }
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,446 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Projection/AudioMixer.hpp>
+#include <f1x/openauto/autoapp/Projection/SimdKernels.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+constexpr uint32_t AudioMixer::cSampleRate;
+constexpr uint32_t AudioMixer::cChannelCount;
+constexpr size_t AudioMixer::cMaxSources;
+constexpr size_t AudioMixer::cNoSource;
+
+// Full scale gain changes take this long.
+static constexpr float cGainRampDuration = 0.05f;
+static constexpr unsigned int cBufferFrames = 1024;
+
+AudioMixer::Source::Source(uint32_t channelCount, uint32_t sampleRate, uint32_t targetLatency, float gain, bool ducksOthers)
+    : channelCount(channelCount)
+    , ducksOthers(ducksOthers)
+    , buffer(channelCount, 16, sampleRate, targetLatency)
+    , resampler(sampleRate, cSampleRate, channelCount)
+    , isOpen(false)
+    , active(false)
+    , gain(gain)
+    , currentGain(0.0f)
+{
+
+}
+
+AudioMixer::AudioMixer(float duckLevel)
+    : duckLevel_(duckLevel)
+    , gainStep_(1.0f / (cGainRampDuration * cSampleRate))
+    , openSources_(0)
+    , bufferFrames_(0)
+{
+    std::vector<RtAudio::Api> apis;
+    RtAudio::getCompiledApi(apis);
+    dac_ = std::find(apis.begin(), apis.end(), RtAudio::LINUX_PULSE) == apis.end() ? std::make_unique<RtAudio>() : std::make_unique<RtAudio>(RtAudio::LINUX_PULSE);
+}
+
+AudioMixer::~AudioMixer()
+{
+    this->closeStream();
+}
+
+size_t AudioMixer::addSource(uint32_t channelCount, uint32_t sampleRate, uint32_t targetLatency, float gain, bool ducksOthers)
+{
+    std::lock_guard<decltype(streamMutex_)> streamLock(streamMutex_);
+    const auto slot = std::find(sources_.begin(), sources_.end(), nullptr);
+
+    if(slot == sources_.end())
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] No free source, " << cMaxSources << " in use.";
+        return cNoSource;
+    }
+
+    // A source joining a running stream is sized and locked here, so the
+    // callback never allocates for it.
+    auto source = std::make_unique<Source>(channelCount, sampleRate, targetLatency, gain, ducksOthers);
+    if(bufferFrames_ > 0)
+    {
+        this->preallocate(*source, bufferFrames_);
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    *slot = std::move(source);
+    return slot - sources_.begin();
+}
+
+void AudioMixer::removeSource(size_t source)
+{
+    if(this->getSource(source) == nullptr)
+    {
+        return;
+    }
+
+    this->close(source);
+
+    // Freed once the callback can no longer see it, but outside the lock.
+    std::unique_ptr<Source> removed;
+
+    {
+        std::lock_guard<decltype(streamMutex_)> streamLock(streamMutex_);
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        removed = std::move(sources_[source]);
+    }
+}
+
+void AudioMixer::setEchoReference(EchoReference::Pointer echoReference)
+{
+    echoReference_ = std::move(echoReference);
+}
+
+bool AudioMixer::open(size_t source)
+{
+    std::lock_guard<decltype(streamMutex_)> lock(streamMutex_);
+    auto* s = this->getSource(source);
+
+    if(s == nullptr)
+    {
+        return false;
+    }
+
+    if(s->isOpen)
+    {
+        return true;
+    }
+
+    if(openSources_ == 0 && !this->openStream())
+    {
+        return false;
+    }
+
+    ++openSources_;
+    s->isOpen = true;
+    return s->buffer.open(QIODevice::ReadWrite);
+}
+
+void AudioMixer::close(size_t source)
+{
+    std::lock_guard<decltype(streamMutex_)> lock(streamMutex_);
+    auto* s = this->getSource(source);
+
+    if(s == nullptr || !s->isOpen)
+    {
+        return;
+    }
+
+    this->suspend(source);
+    s->isOpen = false;
+
+    if(--openSources_ == 0)
+    {
+        this->closeStream();
+    }
+}
+
+void AudioMixer::write(size_t source, uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    if(auto* s = this->getSource(source))
+    {
+        s->buffer.push(reinterpret_cast<const char*>(buffer.cdata), buffer.size, timestamp);
+    }
+}
+
+void AudioMixer::start(size_t source)
+{
+    if(auto* s = this->getSource(source))
+    {
+        s->active = true;
+    }
+}
+
+void AudioMixer::suspend(size_t source)
+{
+    if(auto* s = this->getSource(source))
+    {
+        s->active = false;
+
+        // Whatever is queued belongs to the stream that just ended.
+        this->flush(source);
+    }
+}
+
+void AudioMixer::flush(size_t source)
+{
+    auto* s = this->getSource(source);
+
+    if(s == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    s->buffer.flush();
+    s->resampler.reset();
+    s->currentGain = 0.0f;
+}
+
+void AudioMixer::setGain(size_t source, float gain)
+{
+    if(auto* s = this->getSource(source))
+    {
+        s->gain = gain;
+    }
+}
+
+AudioBufferStats AudioMixer::getBufferStats(size_t source) const
+{
+    auto* s = this->getSource(source);
+
+    if(s == nullptr)
+    {
+        return AudioBufferStats();
+    }
+
+    // A source's pulls are only part of the callback, which is timed as a whole.
+    auto stats = s->buffer.getStats();
+    stats.callbackOverruns = callbackMonitor_.getOverruns();
+    stats.maxCallbackLoad = callbackMonitor_.getMaxLoad();
+    return stats;
+}
+
+MediaClock::Pointer AudioMixer::getMediaClock(size_t source) const
+{
+    auto* s = this->getSource(source);
+    return s != nullptr ? s->buffer.getMediaClock() : nullptr;
+}
+
+// A slot only changes while its owner adds or removes it, so the owner may use
+// it without holding a lock.
+AudioMixer::Source* AudioMixer::getSource(size_t source) const
+{
+    return source < cMaxSources ? sources_[source].get() : nullptr;
+}
+
+bool AudioMixer::openStream()
+{
+    if(dac_->getDeviceCount() == 0)
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] No output devices found.";
+        return false;
+    }
+
+    RtAudio::StreamParameters parameters;
+    parameters.deviceId = dac_->getDefaultOutputDevice();
+    parameters.nChannels = cChannelCount;
+    parameters.firstChannel = 0;
+
+    RtAudio::StreamOptions streamOptions;
+    streamOptions.flags = RTAUDIO_MINIMIZE_LATENCY | RTAUDIO_SCHEDULE_REALTIME;
+    unsigned int bufferFrames = cBufferFrames;
+
+#if RTAUDIO_VERSION_MAJOR >= 6
+    if(dac_->openStream(&parameters, nullptr, RTAUDIO_SINT16, cSampleRate, &bufferFrames, &AudioMixer::audioBufferReadHandler, static_cast<void*>(this), &streamOptions) == RTAUDIO_NO_ERROR)
+    {
+        this->preallocate(bufferFrames);
+    }
+
+    if(!dac_->isStreamOpen() || dac_->startStream() != RTAUDIO_NO_ERROR)
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] Failed to open audio output, what: " << dac_->getErrorText();
+        this->closeStream();
+        return false;
+    }
+#else
+    try
+    {
+        dac_->openStream(&parameters, nullptr, RTAUDIO_SINT16, cSampleRate, &bufferFrames, &AudioMixer::audioBufferReadHandler, static_cast<void*>(this), &streamOptions);
+        this->preallocate(bufferFrames);
+        dac_->startStream();
+    }
+    catch(const RtAudioError& e)
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] Failed to open audio output, what: " << e.what();
+        this->closeStream();
+        return false;
+    }
+#endif
+
+    bufferFrames_ = bufferFrames;
+    OPENAUTO_LOG(info) << "[AudioMixer] Opened output, sample rate: " << cSampleRate << ", buffer frames: " << bufferFrames;
+    return true;
+}
+
+void AudioMixer::closeStream()
+{
+    bufferFrames_ = 0;
+
+#if RTAUDIO_VERSION_MAJOR < 6
+    try
+    {
+#endif
+        if(dac_->isStreamOpen() && dac_->isStreamRunning())
+        {
+            dac_->stopStream();
+        }
+
+        if(dac_->isStreamOpen())
+        {
+            dac_->closeStream();
+        }
+#if RTAUDIO_VERSION_MAJOR < 6
+    }
+    catch(const RtAudioError& e)
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] Failed to close audio output, what: " << e.what();
+    }
+#endif
+}
+
+// Sizes every scratch buffer for the period the device asked for, so that the
+// callback only ever resizes within capacity.
+void AudioMixer::preallocate(size_t frames)
+{
+    mixBuffer_.reserve(frames * cChannelCount);
+    upmixBuffer_.reserve(frames * cChannelCount);
+
+    for(auto& source : sources_)
+    {
+        if(source != nullptr)
+        {
+            this->preallocate(*source, frames);
+        }
+    }
+}
+
+void AudioMixer::preallocate(Source& source, size_t frames)
+{
+    // The resamplers consume a frame more or less from one call to the next.
+    const size_t slack = 2;
+
+    const size_t inputFrames = source.resampler.getInputFrames(frames) + slack;
+    source.samples.reserve(inputFrames * source.channelCount);
+    source.input.reserve(inputFrames * source.channelCount);
+    source.output.reserve(frames * source.channelCount);
+
+    if(!source.buffer.lockMemory())
+    {
+        OPENAUTO_LOG(warning) << "[AudioMixer] Failed to lock audio buffer in memory, playback may glitch under memory pressure.";
+    }
+}
+
+void AudioMixer::mix(int16_t* output, size_t frames)
+{
+    const size_t sampleCount = frames * cChannelCount;
+    mixBuffer_.assign(sampleCount, 0.0f);
+
+    const bool ducking = std::any_of(sources_.begin(), sources_.end(), [](const std::unique_ptr<Source>& source) {
+        return source != nullptr && source->active && source->ducksOthers;
+    });
+
+    for(auto& source : sources_)
+    {
+        if(source != nullptr && source->active)
+        {
+            const float targetGain = source->gain * (ducking && !source->ducksOthers ? duckLevel_ : 1.0f);
+            this->mixSource(*source, frames, targetGain);
+        }
+    }
+
+    simd::floatToInt16(mixBuffer_.data(), output, sampleCount);
+}
+
+void AudioMixer::mixSource(Source& source, size_t frames, float targetGain)
+{
+    const size_t inputFrames = source.resampler.getInputFrames(frames);
+    source.samples.resize(inputFrames * source.channelCount);
+    source.buffer.pull(reinterpret_cast<char*>(source.samples.data()), source.samples.size() * sizeof(int16_t));
+
+    source.input.resize(source.samples.size());
+    simd::int16ToFloat(source.samples.data(), source.input.data(), source.samples.size());
+    source.output.resize(frames * source.channelCount);
+    source.resampler.process(source.input.data(), source.output.data(), frames);
+
+    const float* samples = source.output.data();
+    if(source.channelCount == 1)
+    {
+        upmixBuffer_.resize(frames * cChannelCount);
+
+        for(size_t i = 0; i < frames; ++i)
+        {
+            upmixBuffer_[i * 2] = upmixBuffer_[i * 2 + 1] = samples[i];
+        }
+
+        samples = upmixBuffer_.data();
+    }
+
+    if(source.currentGain == targetGain)
+    {
+        simd::mixInto(mixBuffer_.data(), samples, targetGain, frames * cChannelCount);
+        return;
+    }
+
+    for(size_t i = 0; i < frames; ++i)
+    {
+        source.currentGain = targetGain > source.currentGain
+            ? std::min(source.currentGain + gainStep_, targetGain)
+            : std::max(source.currentGain - gainStep_, targetGain);
+
+        mixBuffer_[i * 2] += samples[i * 2] * source.currentGain;
+        mixBuffer_[i * 2 + 1] += samples[i * 2 + 1] * source.currentGain;
+    }
+}
+
+int AudioMixer::audioBufferReadHandler(void* outputBuffer, void*, unsigned int nBufferFrames,
+                                       double, RtAudioStreamStatus, void* userData)
+{
+    AudioMixer* self = static_cast<AudioMixer*>(userData);
+    auto output = static_cast<int16_t*>(outputBuffer);
+    const auto start = AudioCallbackMonitor::now();
+
+    // Never wait in the audio callback; a source being flushed costs one
+    // period of silence.
+    std::unique_lock<decltype(self->mutex_)> lock(self->mutex_, std::try_to_lock);
+
+    if(lock.owns_lock())
+    {
+        self->mix(output, nBufferFrames);
+    }
+    else
+    {
+        std::fill(output, output + nBufferFrames * cChannelCount, 0);
+        self->mixBuffer_.assign(nBufferFrames * cChannelCount, 0.0f);
+    }
+
+    // Silence included, so the reference keeps pace with the device.
+    if(self->echoReference_ != nullptr)
+    {
+        self->echoReference_->write(self->mixBuffer_.data(), nBufferFrames);
+    }
+
+    self->callbackMonitor_.record(start, static_cast<uint64_t>(nBufferFrames) * 1000000 / cSampleRate);
+    return 0;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,106 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/AudioOutputPool.hpp>
+#include <f1x/openauto/autoapp/Projection/PooledAudioOutput.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+IAudioOutput::Pointer AudioOutputPool::acquire(const std::string& key, const std::string& signature, const Factory& factory)
+{
+    ParkedOutput parkedOutput{std::string(), nullptr, false};
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        auto iter = parkedOutputs_.find(key);
+
+        if(iter != parkedOutputs_.end())
+        {
+            parkedOutput = std::move(iter->second);
+            parkedOutputs_.erase(iter);
+        }
+    }
+
+    if(parkedOutput.output != nullptr && parkedOutput.signature != signature)
+    {
+        OPENAUTO_LOG(info) << "[AudioOutputPool] settings changed, closing output: " << key;
+        parkedOutput.output->stop();
+        parkedOutput.output.reset();
+    }
+
+    if(parkedOutput.output != nullptr)
+    {
+        OPENAUTO_LOG(info) << "[AudioOutputPool] reusing output: " << key << ", open: " << parkedOutput.isOpen;
+    }
+    else
+    {
+        parkedOutput.output = factory();
+        parkedOutput.isOpen = false;
+    }
+
+    return std::make_shared<PooledAudioOutput>(this->shared_from_this(), key, signature, std::move(parkedOutput.output), parkedOutput.isOpen);
+}
+
+void AudioOutputPool::clear()
+{
+    std::map<std::string, ParkedOutput> parkedOutputs;
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        parkedOutputs.swap(parkedOutputs_);
+    }
+
+    for(auto& parkedOutput : parkedOutputs)
+    {
+        parkedOutput.second.output->stop();
+    }
+}
+
+void AudioOutputPool::park(const std::string& key, const std::string& signature, IAudioOutput::Pointer output, bool isOpen)
+{
+    IAudioOutput::Pointer replacedOutput;
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        auto& parkedOutput = parkedOutputs_[key];
+        replacedOutput = std::move(parkedOutput.output);
+        parkedOutput.signature = signature;
+        parkedOutput.output = std::move(output);
+        parkedOutput.isOpen = isOpen;
+    }
+
+    // Only one output per key is kept warm.
+    if(replacedOutput != nullptr)
+    {
+        replacedOutput->stop();
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,53 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QCoreApplication>
+#include <f1x/openauto/autoapp/Projection/AudioThread.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+QThread* AudioThread::instance()
+{
+    static QThread* thread = [] {
+        auto thread = new QThread();
+        thread->setObjectName("audio");
+
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [thread]() {
+            thread->quit();
+            thread->wait();
+        });
+
+        thread->start(QThread::TimeCriticalPriority);
+        return thread;
+    }();
+
+    return thread;
+}
+
+}
+}
+}
+}
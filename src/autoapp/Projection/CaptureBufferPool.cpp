@@ -0,0 +1,90 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/CaptureBufferPool.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+CaptureBufferPool::CaptureBufferPool(size_t bufferCount, size_t bufferSize)
+    : bufferCount_(bufferCount)
+    , bufferSize_(bufferSize)
+    , misses_(0)
+{
+    freeBuffers_.reserve(bufferCount_);
+
+    for(size_t i = 0; i < bufferCount_; ++i)
+    {
+        aasdk::common::Data data;
+        data.reserve(bufferSize_);
+        freeBuffers_.push_back(std::move(data));
+    }
+}
+
+aasdk::common::Data CaptureBufferPool::acquire()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+        if(!freeBuffers_.empty())
+        {
+            auto data = std::move(freeBuffers_.back());
+            freeBuffers_.pop_back();
+            data.clear();
+            return data;
+        }
+    }
+
+    ++misses_;
+    aasdk::common::Data data;
+    data.reserve(bufferSize_);
+    return data;
+}
+
+void CaptureBufferPool::release(aasdk::common::Data data)
+{
+    // A buffer whose storage was moved away on its way out is of no use.
+    if(data.capacity() < bufferSize_)
+    {
+        return;
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(freeBuffers_.size() < bufferCount_)
+    {
+        freeBuffers_.push_back(std::move(data));
+    }
+}
+
+uint64_t CaptureBufferPool::getMisses() const
+{
+    return misses_;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,111 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Projection/EchoReference.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Reference audio kept for the consumer, in seconds.
+static constexpr size_t cCapacity = 1;
+
+EchoReference::EchoReference(uint32_t inputRate, uint32_t inputChannelCount, uint32_t outputRate)
+    : inputRate_(inputRate)
+    , inputChannelCount_(inputChannelCount)
+    , outputRate_(outputRate)
+    , resampler_(inputRate, outputRate, 1)
+    , pending_(cMaxBlockFrames * 2, 0.0f)
+    , pendingFrames_(0)
+    , converted_(cMaxBlockFrames * 2, 0.0f)
+    , samples_(outputRate * cCapacity * sizeof(float))
+{
+
+}
+
+void EchoReference::write(const float* frames, size_t frameCount)
+{
+    while(frameCount > 0)
+    {
+        const auto blockFrames = std::min(frameCount, cMaxBlockFrames);
+
+        for(size_t i = 0; i < blockFrames; ++i)
+        {
+            float sum = 0.0f;
+
+            for(uint32_t channel = 0; channel < inputChannelCount_; ++channel)
+            {
+                sum += frames[i * inputChannelCount_ + channel];
+            }
+
+            pending_[pendingFrames_ + i] = sum / inputChannelCount_;
+        }
+
+        pendingFrames_ += blockFrames;
+        frames += blockFrames * inputChannelCount_;
+        frameCount -= blockFrames;
+
+        // As many output samples as the pending input covers; the rest of the
+        // input waits for the next block.
+        size_t outputFrames = pendingFrames_ * outputRate_ / inputRate_ + 1;
+        while(outputFrames > 0 && resampler_.getInputFrames(outputFrames) > pendingFrames_)
+        {
+            --outputFrames;
+        }
+
+        const auto consumed = resampler_.getInputFrames(outputFrames);
+        resampler_.process(pending_.data(), converted_.data(), outputFrames);
+        std::copy(pending_.begin() + consumed, pending_.begin() + pendingFrames_, pending_.begin());
+        pendingFrames_ -= consumed;
+
+        // Nobody reading means nobody cares about what gets dropped here.
+        samples_.write(reinterpret_cast<const char*>(converted_.data()), outputFrames * sizeof(float));
+    }
+}
+
+size_t EchoReference::read(float* samples, size_t count)
+{
+    return samples_.read(reinterpret_cast<char*>(samples), count * sizeof(float)) / sizeof(float);
+}
+
+void EchoReference::trim(size_t keep)
+{
+    const auto count = this->available();
+
+    if(count > keep)
+    {
+        samples_.skip((count - keep) * sizeof(float));
+    }
+}
+
+size_t EchoReference::available() const
+{
+    return samples_.size() / sizeof(float);
+}
+
+}
+}
+}
+}
@@ -31,7 +31,12 @@ namespace autoapp
 namespace projection
 {
 
-GstAudioOutput::GstAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+// Amount of audio handed to appsrc per need-data, in milliseconds.
+static constexpr uint32_t cPeriodDuration = 10;
+
+GstAudioOutput::GstAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency)
+    : audioBuffer_(channelCount, sampleSize, sampleRate, targetLatency)
+    , periodSize_(sampleRate * cPeriodDuration / 1000 * channelCount * (sampleSize / 8))
 {
     g_autoptr(GError) error = nullptr;
 
@@ -59,29 +64,52 @@ GstAudioOutput::GstAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint3
 
     g_autoptr(GstCaps) caps = gst_audio_info_to_caps(&audioInfo_);
     gst_app_src_set_caps(appsrc_.get(), caps);
+
+    // appsrc pulls from the jitter buffer at the pace of the sink instead of
+    // queueing whatever the phone sends, so keep its own queue to a couple of
+    // periods.
+    gst_app_src_set_max_bytes(appsrc_.get(), periodSize_ * 2);
+
+    GstAppSrcCallbacks callbacks = {};
+    callbacks.need_data = &GstAudioOutput::onNeedData;
+    gst_app_src_set_callbacks(appsrc_.get(), &callbacks, this, nullptr);
 }
 
 bool GstAudioOutput::open()
 {
     if (!gstPipeline_)
         return false;
+
+    if (!audioBuffer_.lockMemory())
+    {
+        OPENAUTO_LOG(warning) << "[GstAudioOutput] Failed to lock audio buffer in memory, playback may glitch under memory pressure.";
+    }
     
     auto stateChangeRet = gst_element_set_state(GST_ELEMENT(gstPipeline_.get()), GST_STATE_PAUSED);
     return stateChangeRet != GST_STATE_CHANGE_FAILURE;
 }
 
-void GstAudioOutput::write(aasdk::messenger::Timestamp::ValueType, const aasdk::common::DataConstBuffer& buffer)
+void GstAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    if (!appsrc_)
-        return;
+    audioBuffer_.push(reinterpret_cast<const char*>(buffer.cdata), buffer.size, timestamp);
+}
 
-    auto gstBuffer = gst_buffer_new_memdup(buffer.cdata, buffer.size);
+// Called from the appsrc streaming thread, which makes it the only consumer
+// of audioBuffer_.
+// static
+void GstAudioOutput::onNeedData(GstAppSrc * appsrc, guint, gpointer user_data)
+{
+    auto self = static_cast<GstAudioOutput *>(user_data);
 
-    // The document seems to infer that it's safe to push the buffer from
-    // arbitrary thread.
-    // FIXME: it's not clear if we have to wait for the appsrc to be in certain
-    // state before we can start pushing data.
-    gst_app_src_push_buffer(appsrc_.get(), gstBuffer);
+    auto gstBuffer = gst_buffer_new_allocate(nullptr, self->periodSize_, nullptr);
+    GstMapInfo map;
+
+    if (gst_buffer_map(gstBuffer, &map, GST_MAP_WRITE)) {
+        self->audioBuffer_.pull(reinterpret_cast<char *>(map.data), map.size);
+        gst_buffer_unmap(gstBuffer, &map);
+    }
+
+    gst_app_src_push_buffer(appsrc, gstBuffer);
 }
 
 void GstAudioOutput::start()
@@ -98,16 +126,30 @@ void GstAudioOutput::stop()
         return;
 
     gst_element_set_state(GST_ELEMENT(gstPipeline_.get()), GST_STATE_NULL);
+    audioBuffer_.flush();
 }
 
 void GstAudioOutput::suspend()
 {
+    audioBuffer_.endOfStream();
+
     if (!gstPipeline_)
         return;
 
     gst_element_set_state(GST_ELEMENT(gstPipeline_.get()), GST_STATE_PAUSED);
 }
 
+void GstAudioOutput::flush()
+{
+    // The appsrc streaming thread may still be pulling.
+    audioBuffer_.requestFlush();
+}
+
+void GstAudioOutput::setGain(float gain)
+{
+    audioBuffer_.setGain(gain);
+}
+
 uint32_t GstAudioOutput::getSampleSize() const
 {
     return audioInfo_.finfo->width;
@@ -123,6 +165,32 @@ uint32_t GstAudioOutput::getSampleRate() const
     return audioInfo_.rate;
 }
 
+std::vector<AudioFormat> GstAudioOutput::getSupportedFormats() const
+{
+    // The caps are fixed when the pipeline is built; audioresample takes care
+    // of whatever the sink wants.
+    AudioFormat format;
+    format.sampleRate = this->getSampleRate();
+    format.sampleSize = this->getSampleSize();
+    format.channelCount = this->getChannelCount();
+    return {format};
+}
+
+bool GstAudioOutput::setFormat(const AudioFormat& format)
+{
+    return format == this->getSupportedFormats().front();
+}
+
+AudioBufferStats GstAudioOutput::getBufferStats() const
+{
+    return audioBuffer_.getStats();
+}
+
+MediaClock::Pointer GstAudioOutput::getMediaClock() const
+{
+    return audioBuffer_.getMediaClock();
+}
+
 }
 }
 }
@@ -0,0 +1,90 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/H264FrameInfo.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+enum NalUnitType
+{
+    cNalSlice = 1,
+    cNalIdrSlice = 5,
+    cNalSps = 7,
+    cNalPps = 8
+};
+
+}
+
+H264FrameInfo parseH264Frame(const aasdk::common::DataConstBuffer& buffer)
+{
+    H264FrameInfo info;
+
+    // Every NAL unit header follows a 00 00 01 start code (the four byte form
+    // ends the same way), so scanning for that is enough.
+    for(size_t i = 2; i + 1 < buffer.size; ++i)
+    {
+        if(buffer.cdata[i] != 1 || buffer.cdata[i - 1] != 0 || buffer.cdata[i - 2] != 0)
+        {
+            continue;
+        }
+
+        const auto header = buffer.cdata[i + 1];
+        const auto type = header & 0x1f;
+        const auto refIdc = (header >> 5) & 0x03;
+
+        switch(type)
+        {
+        case cNalSlice:
+        case cNalIdrSlice:
+            // All slices of a picture agree on these, and parameter sets come
+            // first, so there is no need to scan the rest of the payload.
+            info.hasSlices = true;
+            info.isIdr = type == cNalIdrSlice;
+            info.isReference = refIdc != 0;
+            return info;
+
+        case cNalSps:
+        case cNalPps:
+            info.hasParameterSets = true;
+            break;
+
+        default:
+            break;
+        }
+
+        ++i;
+    }
+
+    return info;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,131 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+MediaClock::MediaClock()
+    : sequence_(0)
+    , valid_(false)
+    , anchorTimestamp_(0)
+    , anchorTime_(0)
+{
+}
+
+void MediaClock::update(uint64_t timestamp, uint64_t delay)
+{
+    const auto sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    anchorTimestamp_.store(timestamp, std::memory_order_relaxed);
+    anchorTime_.store(now() + static_cast<int64_t>(delay), std::memory_order_relaxed);
+    valid_.store(true, std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void MediaClock::invalidate()
+{
+    if(valid_.load(std::memory_order_relaxed))
+    {
+        const auto sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        valid_.store(false, std::memory_order_relaxed);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+}
+
+bool MediaClock::isValid() const
+{
+    return valid_.load(std::memory_order_acquire);
+}
+
+bool MediaClock::getTime(uint64_t& timestamp) const
+{
+    int64_t time;
+
+    if(!this->getAnchor(timestamp, time))
+    {
+        return false;
+    }
+
+    // The anchor usually lies in the future; the difference is simply the
+    // audio still queued in the device ahead of it.
+    timestamp += static_cast<uint64_t>(now() - time);
+    return true;
+}
+
+bool MediaClock::toLocalTime(uint64_t timestamp, TimePoint& localTime) const
+{
+    uint64_t anchorTimestamp;
+    int64_t anchorTime;
+
+    if(!this->getAnchor(anchorTimestamp, anchorTime))
+    {
+        return false;
+    }
+
+    const auto offset = static_cast<int64_t>(timestamp - anchorTimestamp);
+    localTime = TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::microseconds(anchorTime + offset)));
+    return true;
+}
+
+bool MediaClock::getAnchor(uint64_t& timestamp, int64_t& time) const
+{
+    uint32_t sequence;
+    bool valid;
+
+    do
+    {
+        sequence = sequence_.load(std::memory_order_acquire);
+
+        if(sequence & 1)
+        {
+            continue;
+        }
+
+        valid = valid_.load(std::memory_order_relaxed);
+        timestamp = anchorTimestamp_.load(std::memory_order_relaxed);
+        time = anchorTime_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    while((sequence & 1) || sequence != sequence_.load(std::memory_order_relaxed));
+
+    return valid;
+}
+
+int64_t MediaClock::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+}
+}
+}
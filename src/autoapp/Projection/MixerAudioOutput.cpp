@@ -0,0 +1,133 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/MixerAudioOutput.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+MixerAudioOutput::MixerAudioOutput(AudioMixer::Pointer mixer, uint32_t channelCount, uint32_t sampleRate, uint32_t targetLatency, float gain, bool ducksOthers)
+    : mixer_(std::move(mixer))
+    , channelCount_(channelCount)
+    , sampleRate_(sampleRate)
+    , gain_(gain)
+    , source_(mixer_->addSource(channelCount, sampleRate, targetLatency, gain, ducksOthers))
+{
+
+}
+
+MixerAudioOutput::~MixerAudioOutput()
+{
+    mixer_->removeSource(source_);
+}
+
+bool MixerAudioOutput::open()
+{
+    // The mixer had no slot left; the channel stays silent instead of taking
+    // one from another output.
+    if(source_ == AudioMixer::cNoSource)
+    {
+        OPENAUTO_LOG(error) << "[MixerAudioOutput] no mixer source, cannot open.";
+        return false;
+    }
+
+    return mixer_->open(source_);
+}
+
+void MixerAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    mixer_->write(source_, timestamp, buffer);
+}
+
+void MixerAudioOutput::start()
+{
+    mixer_->start(source_);
+}
+
+void MixerAudioOutput::stop()
+{
+    mixer_->close(source_);
+}
+
+void MixerAudioOutput::suspend()
+{
+    mixer_->suspend(source_);
+}
+
+void MixerAudioOutput::flush()
+{
+    mixer_->flush(source_);
+}
+
+void MixerAudioOutput::setGain(float gain)
+{
+    mixer_->setGain(source_, gain_ * gain);
+}
+
+uint32_t MixerAudioOutput::getSampleSize() const
+{
+    return 16;
+}
+
+uint32_t MixerAudioOutput::getChannelCount() const
+{
+    return channelCount_;
+}
+
+uint32_t MixerAudioOutput::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+std::vector<AudioFormat> MixerAudioOutput::getSupportedFormats() const
+{
+    // The mixer converts every source to the device format itself.
+    AudioFormat format;
+    format.sampleRate = sampleRate_;
+    format.sampleSize = 16;
+    format.channelCount = channelCount_;
+    return {format};
+}
+
+bool MixerAudioOutput::setFormat(const AudioFormat& format)
+{
+    return format == this->getSupportedFormats().front();
+}
+
+AudioBufferStats MixerAudioOutput::getBufferStats() const
+{
+    return mixer_->getBufferStats(source_);
+}
+
+MediaClock::Pointer MixerAudioOutput::getMediaClock() const
+{
+    return mixer_->getMediaClock(source_);
+}
+
+}
+}
+}
+}
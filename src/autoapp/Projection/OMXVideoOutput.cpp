@@ -48,6 +48,8 @@ OMXVideoOutput::OMXVideoOutput(configuration::IConfiguration::Pointer configurat
     : VideoOutput(std::move(configuration))
     , isActive_(false)
     , portSettingsChanged_(false)
+    , clockStarted_(false)
+    , buffersInFlight_(0)
     , client_(nullptr)
 {
     memset(components_, 0, sizeof(components_));
@@ -74,6 +76,10 @@ bool OMXVideoOutput::open()
         return false;
     }
 
+    buffersInFlight_ = 0;
+    tracedBuffers_.clear();
+    ilclient_set_empty_buffer_done_callback(client_, &OMXVideoOutput::onEmptyBufferDone, this);
+
     if(!this->createComponents())
     {
         return false;
@@ -95,6 +101,7 @@ bool OMXVideoOutput::open()
     }
 
     isActive_ = true;
+    clockStarted_ = false;
     return true;
 }
 
@@ -141,14 +148,24 @@ void OMXVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuf
             aasdk::common::DataConstBuffer currentBuffer(buffer.cdata, buffer.size, writeSize);
             buf->nFilledLen = std::min<size_t>(buf->nAllocLen, currentBuffer.size);
             memcpy(buf->pBuffer, &currentBuffer.cdata[0], buf->nFilledLen);
-            buf->nTimeStamp = omx_ticks_from_s64(timestamp / 1000000);
-            buf->nOffset = 0;           
-            
+            buf->nTimeStamp = omx_ticks_from_s64(timestamp);
+            buf->nOffset = 0;
+
             writeSize += buf->nFilledLen;
-            
-            if(timestamp == 0)
+
+            // Only the first buffer of the stream starts the clock; every later
+            // frame is scheduled against it by its own timestamp.
+            buf->nFlags = 0;
+
+            if(!clockStarted_)
             {
-              buf->nFlags = OMX_BUFFERFLAG_STARTTIME;
+                buf->nFlags |= OMX_BUFFERFLAG_STARTTIME;
+                clockStarted_ = true;
+            }
+
+            if(writeSize == buffer.size)
+            {
+                buf->nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
             }
 
             if(!portSettingsChanged_ && ilclient_remove_event(components_[VideoComponent::DECODER], OMX_EventPortSettingsChanged, 131, 0, 0, 1) == 0)
@@ -169,12 +186,36 @@ void OMXVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuf
                 ilclient_change_component_state(components_[VideoComponent::RENDERER], OMX_StateExecuting);
             }
 
+            if(latencyTracer_->isEnabled())
+            {
+                // Input buffers come back in the order they were submitted;
+                // remember which one completes each frame. This has to happen
+                // before the buffer is handed over, it may come back at once.
+                std::lock_guard<decltype(tracedBuffersMutex_)> tracedBuffersLock(tracedBuffersMutex_);
+                tracedBuffers_.emplace_back(timestamp, writeSize == buffer.size);
+            }
+
+            ++buffersInFlight_;
+
             if(OMX_EmptyThisBuffer(ILC_GET_HANDLE(components_[VideoComponent::DECODER]), buf) != OMX_ErrorNone)
             {
+                --buffersInFlight_;
+
+                if(latencyTracer_->isEnabled())
+                {
+                    std::lock_guard<decltype(tracedBuffersMutex_)> tracedBuffersLock(tracedBuffersMutex_);
+                    tracedBuffers_.pop_back();
+                }
+
                 break;
             }
         }
     }
+
+    if(writeSize == buffer.size)
+    {
+        latencyTracer_->record(VideoLatencyTracer::Stage::ENQUEUED, timestamp);
+    }
 }
 
 void OMXVideoOutput::stop()
@@ -202,6 +243,38 @@ void OMXVideoOutput::stop()
     }
 }
 
+size_t OMXVideoOutput::getQueueDepth() const
+{
+    // Counted in input buffers; a frame rarely spans more than one.
+    return buffersInFlight_;
+}
+
+void OMXVideoOutput::onEmptyBufferDone(void* userData, COMPONENT_T*)
+{
+    auto self = static_cast<OMXVideoOutput*>(userData);
+
+    if(self->buffersInFlight_ > 0)
+    {
+        --self->buffersInFlight_;
+    }
+
+    // The renderer is tunneled, so the decoder taking the last input buffer
+    // of a frame is as far as the frame can be followed. That is not decoder
+    // output, so DECODED stays empty for this backend.
+    std::lock_guard<decltype(self->tracedBuffersMutex_)> lock(self->tracedBuffersMutex_);
+
+    if(!self->tracedBuffers_.empty())
+    {
+        const auto tracedBuffer = self->tracedBuffers_.front();
+        self->tracedBuffers_.pop_front();
+
+        if(tracedBuffer.second)
+        {
+            self->latencyTracer_->record(VideoLatencyTracer::Stage::DECODER_INPUT, tracedBuffer.first);
+        }
+    }
+}
+
 bool OMXVideoOutput::createComponents()
 {
     if(ilclient_create_component(client_, &components_[VideoComponent::DECODER], const_cast<char*>("video_decode"), static_cast<ILCLIENT_CREATE_FLAGS_T>(ILCLIENT_DISABLE_ALL_PORTS | ILCLIENT_ENABLE_INPUT_BUFFERS)) != 0)
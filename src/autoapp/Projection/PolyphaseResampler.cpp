@@ -0,0 +1,169 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <f1x/openauto/autoapp/Projection/PolyphaseResampler.hpp>
+#include <f1x/openauto/autoapp/Projection/SimdKernels.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+uint32_t greatestCommonDivisor(uint32_t a, uint32_t b)
+{
+    while(b != 0)
+    {
+        const auto remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a;
+}
+
+}
+
+PolyphaseResampler::PolyphaseResampler(uint32_t inputRate, uint32_t outputRate, uint32_t channelCount)
+    : channelCount_(channelCount)
+    , phase_(0)
+    , history_(channelCount)
+{
+    const auto divisor = greatestCommonDivisor(inputRate, outputRate);
+    interpolation_ = outputRate / divisor;
+    decimation_ = inputRate / divisor;
+
+    this->designFilter();
+    this->reset();
+}
+
+bool PolyphaseResampler::isPassthrough() const
+{
+    return interpolation_ == decimation_;
+}
+
+size_t PolyphaseResampler::getInputFrames(size_t outputFrames) const
+{
+    return (phase_ + outputFrames * decimation_) / interpolation_;
+}
+
+void PolyphaseResampler::process(const float* input, float* output, size_t outputFrames)
+{
+    if(this->isPassthrough())
+    {
+        std::copy(input, input + outputFrames * channelCount_, output);
+        return;
+    }
+
+    const auto inputFrames = this->getInputFrames(outputFrames);
+    uint32_t phase = phase_;
+
+    for(uint32_t channel = 0; channel < channelCount_; ++channel)
+    {
+        auto& samples = history_[channel];
+        samples.resize(cTapsPerPhase + inputFrames);
+
+        for(size_t i = 0; i < inputFrames; ++i)
+        {
+            samples[cTapsPerPhase + i] = input[i * channelCount_ + channel];
+        }
+
+        // Each output sample is the dot product of one filter phase with the
+        // newest cTapsPerPhase inputs; every L/M outputs consume one input.
+        phase = phase_;
+        size_t newest = cTapsPerPhase - 1;
+
+        for(size_t i = 0; i < outputFrames; ++i)
+        {
+            output[i * channelCount_ + channel] = simd::dotProduct(&coefficients_[phase * cTapsPerPhase], &samples[newest + 1 - cTapsPerPhase], cTapsPerPhase);
+
+            phase += decimation_;
+            newest += phase / interpolation_;
+            phase %= interpolation_;
+        }
+
+        std::copy(samples.end() - cTapsPerPhase, samples.end(), samples.begin());
+    }
+
+    phase_ = phase;
+}
+
+void PolyphaseResampler::reset()
+{
+    phase_ = 0;
+
+    for(auto& samples : history_)
+    {
+        // Enough for a 100 ms block at 48 kHz without allocating in the audio
+        // callback; larger blocks still work, they just grow the buffer.
+        samples.reserve(cTapsPerPhase + 4800);
+        samples.assign(cTapsPerPhase, 0.0f);
+    }
+}
+
+// Windowed sinc low-pass at the upsampled rate, cut off a little below the
+// lower of the two Nyquist frequencies, with a gain of L to make up for the
+// zeros the upsampling stuffs in.
+void PolyphaseResampler::designFilter()
+{
+    if(this->isPassthrough())
+    {
+        return;
+    }
+
+    const size_t length = cTapsPerPhase * interpolation_;
+    const double center = (length - 1) / 2.0;
+    const double cutoff = 0.45 / std::max(interpolation_, decimation_);
+    const double pi = std::acos(-1.0);
+
+    std::vector<double> prototype(length);
+    double sum = 0.0;
+
+    for(size_t n = 0; n < length; ++n)
+    {
+        const double x = n - center;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(2.0 * pi * cutoff * x) / (2.0 * pi * cutoff * x);
+        const double window = 0.42 - 0.5 * std::cos(2.0 * pi * n / (length - 1)) + 0.08 * std::cos(4.0 * pi * n / (length - 1));
+        prototype[n] = sinc * window;
+        sum += prototype[n];
+    }
+
+    coefficients_.resize(length);
+
+    for(uint32_t phase = 0; phase < interpolation_; ++phase)
+    {
+        for(size_t tap = 0; tap < cTapsPerPhase; ++tap)
+        {
+            coefficients_[phase * cTapsPerPhase + (cTapsPerPhase - 1 - tap)] = static_cast<float>(prototype[phase + tap * interpolation_] * interpolation_ / sum);
+        }
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,156 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/PooledAudioOutput.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+PooledAudioOutput::PooledAudioOutput(std::weak_ptr<AudioOutputPool> pool, std::string key, std::string signature, IAudioOutput::Pointer output, bool isOpen)
+    : pool_(std::move(pool))
+    , key_(std::move(key))
+    , signature_(std::move(signature))
+    , output_(std::move(output))
+    , isOpen_(isOpen)
+{
+
+}
+
+PooledAudioOutput::~PooledAudioOutput()
+{
+    // Leave the device the way a fresh session expects to find it.
+    output_->suspend();
+    output_->flush();
+    output_->setGain(1.0f);
+
+    if(auto pool = pool_.lock())
+    {
+        pool->park(key_, signature_, std::move(output_), isOpen_);
+    }
+    else
+    {
+        output_->stop();
+    }
+}
+
+bool PooledAudioOutput::open()
+{
+    if(!isOpen_)
+    {
+        isOpen_ = output_->open();
+    }
+
+    return isOpen_;
+}
+
+void PooledAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    output_->write(timestamp, buffer);
+}
+
+void PooledAudioOutput::start()
+{
+    output_->start();
+}
+
+void PooledAudioOutput::stop()
+{
+    output_->suspend();
+    output_->flush();
+}
+
+void PooledAudioOutput::release()
+{
+    output_->stop();
+    isOpen_ = false;
+}
+
+void PooledAudioOutput::suspend()
+{
+    output_->suspend();
+}
+
+void PooledAudioOutput::flush()
+{
+    output_->flush();
+}
+
+void PooledAudioOutput::setGain(float gain)
+{
+    output_->setGain(gain);
+}
+
+uint32_t PooledAudioOutput::getSampleSize() const
+{
+    return output_->getSampleSize();
+}
+
+uint32_t PooledAudioOutput::getChannelCount() const
+{
+    return output_->getChannelCount();
+}
+
+uint32_t PooledAudioOutput::getSampleRate() const
+{
+    return output_->getSampleRate();
+}
+
+std::vector<AudioFormat> PooledAudioOutput::getSupportedFormats() const
+{
+    return output_->getSupportedFormats();
+}
+
+bool PooledAudioOutput::setFormat(const AudioFormat& format)
+{
+    AudioFormat currentFormat;
+    currentFormat.sampleRate = output_->getSampleRate();
+    currentFormat.sampleSize = output_->getSampleSize();
+    currentFormat.channelCount = output_->getChannelCount();
+
+    if(format == currentFormat)
+    {
+        return true;
+    }
+
+    // A different format needs the device reopened for real.
+    output_->stop();
+    isOpen_ = false;
+    return output_->setFormat(format);
+}
+
+AudioBufferStats PooledAudioOutput::getBufferStats() const
+{
+    return output_->getBufferStats();
+}
+
+MediaClock::Pointer PooledAudioOutput::getMediaClock() const
+{
+    return output_->getMediaClock();
+}
+
+}
+}
+}
+}
@@ -0,0 +1,124 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <f1x/openauto/autoapp/Projection/PresentationTimestampGenerator.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Largest disagreement with the free-running timeline a media clock may
+// correct, in microseconds. Anything beyond is taken as the audio and the
+// video not sharing a time base.
+static constexpr int64_t cMaxClockCorrection = 1000000;
+
+PresentationTimestampGenerator::PresentationTimestampGenerator()
+{
+    this->reset();
+}
+
+uint64_t PresentationTimestampGenerator::generate(uint64_t timestamp)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const bool firstFrame = !streamStarted_;
+
+    if(firstFrame)
+    {
+        streamStarted_ = true;
+        streamStart_ = now;
+    }
+
+    const int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - streamStart_).count();
+    int64_t presentationTimestamp = elapsed;
+
+    if(timestamp != 0)
+    {
+        // Follow the phone's frame cadence rather than our arrival jitter,
+        // rebased onto the local stream clock at the first timestamped frame.
+        if(!timestampAnchored_)
+        {
+            timestampAnchored_ = true;
+            timestampOffset_ = elapsed - static_cast<int64_t>(timestamp);
+        }
+
+        presentationTimestamp = static_cast<int64_t>(timestamp) + timestampOffset_;
+
+        MediaClock::TimePoint localTime;
+        if(this->getMediaTime(timestamp, localTime))
+        {
+            const int64_t slavedTimestamp = std::chrono::duration_cast<std::chrono::microseconds>(localTime - streamStart_).count();
+
+            if(slavedTimestamp >= 0 && std::abs(slavedTimestamp - presentationTimestamp) < cMaxClockCorrection)
+            {
+                // Carry the correction over, so that the timeline doesn't
+                // jump back once the audio stops.
+                presentationTimestamp = slavedTimestamp;
+                timestampOffset_ = slavedTimestamp - static_cast<int64_t>(timestamp);
+            }
+        }
+    }
+
+    // Backends schedule by this value, so it must never go backwards.
+    if(!firstFrame && presentationTimestamp <= static_cast<int64_t>(lastPresentationTimestamp_))
+    {
+        presentationTimestamp = lastPresentationTimestamp_ + 1;
+    }
+
+    lastPresentationTimestamp_ = presentationTimestamp;
+    return lastPresentationTimestamp_;
+}
+
+void PresentationTimestampGenerator::reset()
+{
+    streamStarted_ = false;
+    timestampAnchored_ = false;
+    timestampOffset_ = 0;
+    lastPresentationTimestamp_ = 0;
+}
+
+void PresentationTimestampGenerator::setMediaClocks(std::vector<MediaClock::Pointer> mediaClocks)
+{
+    mediaClocks.erase(std::remove(mediaClocks.begin(), mediaClocks.end(), nullptr), mediaClocks.end());
+    mediaClocks_ = std::move(mediaClocks);
+}
+
+bool PresentationTimestampGenerator::getMediaTime(uint64_t timestamp, MediaClock::TimePoint& localTime) const
+{
+    for(const auto& mediaClock : mediaClocks_)
+    {
+        if(mediaClock->toLocalTime(timestamp, localTime))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
+}
+}
+}
@@ -16,7 +16,7 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <QApplication>
+#include <f1x/openauto/autoapp/Projection/AudioThread.hpp>
 #include <f1x/openauto/autoapp/Projection/QtAudioInput.hpp>
 #include <f1x/openauto/Common/Log.hpp>
 
@@ -31,6 +31,7 @@ namespace projection
 
 QtAudioInput::QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
     : ioDevice_(nullptr)
+    , bufferPool_(cBufferCount, cSampleSize)
 {
     qRegisterMetaType<IAudioInput::StartPromise::Pointer>("StartPromise::Pointer");
 
@@ -41,20 +42,42 @@ QtAudioInput::QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t
     audioFormat_.setByteOrder(QAudioFormat::LittleEndian);
     audioFormat_.setSampleType(QAudioFormat::SignedInt);
 
-    this->moveToThread(QApplication::instance()->thread());
+    // Capture runs on the audio thread rather than competing with the UI.
+    this->moveToThread(AudioThread::instance());
     connect(this, &QtAudioInput::startRecording, this, &QtAudioInput::onStartRecording, Qt::QueuedConnection);
     connect(this, &QtAudioInput::stopRecording, this, &QtAudioInput::onStopRecording, Qt::QueuedConnection);
-    QMetaObject::invokeMethod(this, "createAudioInput", Qt::BlockingQueuedConnection);
+    // Opening the device can take a while; open() waits for it instead.
+    QMetaObject::invokeMethod(this, "createAudioInput", Qt::QueuedConnection);
+}
+
+QtAudioInput::~QtAudioInput()
+{
+    // The device has to go away on the thread it captures on.
+    if(this->thread()->isRunning() && this->thread() != QThread::currentThread())
+    {
+        QMetaObject::invokeMethod(this, "destroyAudioInput", Qt::BlockingQueuedConnection);
+    }
+    else
+    {
+        this->destroyAudioInput();
+    }
 }
 
 void QtAudioInput::createAudioInput()
 {
     OPENAUTO_LOG(debug) << "[AudioInput] create.";
     audioInput_ = (std::make_unique<QAudioInput>(QAudioDeviceInfo::defaultInputDevice(), audioFormat_));
+    created_.open();
+}
+
+void QtAudioInput::destroyAudioInput()
+{
+    audioInput_.reset();
 }
 
 bool QtAudioInput::open()
 {
+    created_.wait();
     std::lock_guard<decltype(mutex_)> lock(mutex_);
 
     return ioDevice_ == nullptr;
@@ -85,6 +108,11 @@ void QtAudioInput::read(ReadPromise::Pointer promise)
     }
 }
 
+void QtAudioInput::release(aasdk::common::Data data)
+{
+    bufferPool_.release(std::move(data));
+}
+
 void QtAudioInput::start(StartPromise::Pointer promise)
 {
     emit startRecording(std::move(promise));
@@ -145,6 +173,7 @@ void QtAudioInput::onStopRecording()
     }
 
     audioInput_->stop();
+    OPENAUTO_LOG(debug) << "[AudioInput] stopped, buffer pool misses: " << bufferPool_.getMisses();
 }
 
 void QtAudioInput::onReadyRead()
@@ -156,9 +185,10 @@ void QtAudioInput::onReadyRead()
         return;
     }
 
-    aasdk::common::Data data(cSampleSize, 0);
-    aasdk::common::DataBuffer buffer(data);
-    auto readSize = ioDevice_->read(reinterpret_cast<char*>(buffer.data), buffer.size);
+    // resize() stays within the capacity the pool reserved.
+    auto data = bufferPool_.acquire();
+    data.resize(cSampleSize);
+    auto readSize = ioDevice_->read(reinterpret_cast<char*>(data.data()), data.size());
 
     if(readSize != -1)
     {
@@ -168,6 +198,7 @@ void QtAudioInput::onReadyRead()
     }
     else
     {
+        bufferPool_.release(std::move(data));
         readPromise_->reject();
         readPromise_.reset();
     }
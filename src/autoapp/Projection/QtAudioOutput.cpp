@@ -16,8 +16,8 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <QApplication>
-#include <QThread>
+#include <algorithm>
+#include <f1x/openauto/autoapp/Projection/AudioThread.hpp>
 #include <f1x/openauto/autoapp/Projection/QtAudioOutput.hpp>
 #include <f1x/openauto/Common/Log.hpp>
 
@@ -30,8 +30,8 @@ namespace autoapp
 namespace projection
 {
 
-QtAudioOutput::QtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
-    : audioBuffer_(nullptr)
+QtAudioOutput::QtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency)
+    : audioBuffer_(channelCount, sampleSize, sampleRate, targetLatency)
     , playbackStarted_(false)
 {
     audioFormat_.setChannelCount(channelCount);
@@ -41,34 +41,85 @@ QtAudioOutput::QtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_
     audioFormat_.setByteOrder(QAudioFormat::LittleEndian);
     audioFormat_.setSampleType(QAudioFormat::SignedInt);
 
-    QThread * th = QApplication::instance()->thread();
-    this->moveToThread(th);
-    th->setPriority(QThread::TimeCriticalPriority);
+    this->moveToThread(AudioThread::instance());
 
     connect(this, &QtAudioOutput::startPlayback, this, &QtAudioOutput::onStartPlayback);
     connect(this, &QtAudioOutput::suspendPlayback, this, &QtAudioOutput::onSuspendPlayback);
     connect(this, &QtAudioOutput::stopPlayback, this, &QtAudioOutput::onStopPlayback);
 
-    QMetaObject::invokeMethod(this, "createAudioOutput", Qt::BlockingQueuedConnection);
+    // Opening the device can take a while; open() waits for it instead.
+    QMetaObject::invokeMethod(this, "createAudioOutput", Qt::QueuedConnection);
+}
+
+QtAudioOutput::~QtAudioOutput()
+{
+    // The device has to go away on the thread that feeds it.
+    if(this->thread()->isRunning() && this->thread() != QThread::currentThread())
+    {
+        QMetaObject::invokeMethod(this, "destroyAudioOutput", Qt::BlockingQueuedConnection);
+    }
+    else
+    {
+        this->destroyAudioOutput();
+    }
 }
 
 void QtAudioOutput::createAudioOutput()
 {
     OPENAUTO_LOG(debug) << "[QtAudioOutput] create.";
     audioOutput_ = std::make_unique<QAudioOutput>(QAudioDeviceInfo::defaultOutputDevice(), audioFormat_);
+
+    if(!audioBuffer_.lockMemory())
+    {
+        OPENAUTO_LOG(warning) << "[QtAudioOutput] Failed to lock audio buffer in memory, playback may glitch under memory pressure.";
+    }
+
+    audioBuffer_.open(QIODevice::ReadWrite);
+    created_.open();
 }
 
-bool QtAudioOutput::open()
+void QtAudioOutput::destroyAudioOutput()
 {
-    return true;
+    audioOutput_.reset();
 }
 
-void QtAudioOutput::write(aasdk::messenger::Timestamp::ValueType, const aasdk::common::DataConstBuffer& buffer)
+// The jitter buffer stays open and locked; only the device is opened anew.
+bool QtAudioOutput::recreateAudioOutput(int channelCount, int sampleSize, int sampleRate)
 {
-    if (audioBuffer_ != nullptr)
+    auto audioFormat = audioFormat_;
+    audioFormat.setChannelCount(channelCount);
+    audioFormat.setSampleSize(sampleSize);
+    audioFormat.setSampleRate(sampleRate);
+
+    const auto deviceInfo = QAudioDeviceInfo::defaultOutputDevice();
+    if(!deviceInfo.isFormatSupported(audioFormat))
     {
-        audioBuffer_->write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+        OPENAUTO_LOG(warning) << "[QtAudioOutput] format not supported, sample rate: " << sampleRate
+                              << ", sample size: " << sampleSize << ", channel count: " << channelCount;
+        return false;
+    }
+
+    if(playbackStarted_)
+    {
+        audioOutput_->stop();
+        playbackStarted_ = false;
     }
+
+    audioFormat_ = audioFormat;
+    audioBuffer_.setFormat(channelCount, sampleSize, sampleRate);
+    audioOutput_ = std::make_unique<QAudioOutput>(deviceInfo, audioFormat_);
+    return true;
+}
+
+bool QtAudioOutput::open()
+{
+    created_.wait();
+    return true;
+}
+
+void QtAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    audioBuffer_.push(reinterpret_cast<const char*>(buffer.cdata), buffer.size, timestamp);
 }
 
 void QtAudioOutput::start()
@@ -83,9 +134,20 @@ void QtAudioOutput::stop()
 
 void QtAudioOutput::suspend()
 {
+    audioBuffer_.endOfStream();
     emit suspendPlayback();
 }
 
+void QtAudioOutput::flush()
+{
+    audioBuffer_.requestFlush();
+}
+
+void QtAudioOutput::setGain(float gain)
+{
+    audioBuffer_.setGain(gain);
+}
+
 uint32_t QtAudioOutput::getSampleSize() const
 {
     return audioFormat_.sampleSize();
@@ -101,11 +163,59 @@ uint32_t QtAudioOutput::getSampleRate() const
     return audioFormat_.sampleRate();
 }
 
+std::vector<AudioFormat> QtAudioOutput::getSupportedFormats() const
+{
+    std::vector<AudioFormat> formats;
+    const auto deviceInfo = QAudioDeviceInfo::defaultOutputDevice();
+    const auto preferredSampleRate = deviceInfo.preferredFormat().sampleRate();
+
+    auto sampleRates = deviceInfo.supportedSampleRates();
+    std::stable_partition(sampleRates.begin(), sampleRates.end(), [&](int sampleRate) { return sampleRate == preferredSampleRate; });
+
+    for(const auto sampleRate : sampleRates)
+    {
+        auto audioFormat = audioFormat_;
+        audioFormat.setSampleRate(sampleRate);
+
+        if(deviceInfo.isFormatSupported(audioFormat))
+        {
+            AudioFormat format;
+            format.sampleRate = sampleRate;
+            format.sampleSize = audioFormat.sampleSize();
+            format.channelCount = audioFormat.channelCount();
+            formats.push_back(format);
+        }
+    }
+
+    return formats;
+}
+
+bool QtAudioOutput::setFormat(const AudioFormat& format)
+{
+    bool formatSet = false;
+    QMetaObject::invokeMethod(this, "recreateAudioOutput", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, formatSet),
+                              Q_ARG(int, static_cast<int>(format.channelCount)), Q_ARG(int, static_cast<int>(format.sampleSize)),
+                              Q_ARG(int, static_cast<int>(format.sampleRate)));
+    return formatSet;
+}
+
+AudioBufferStats QtAudioOutput::getBufferStats() const
+{
+    return audioBuffer_.getStats();
+}
+
+MediaClock::Pointer QtAudioOutput::getMediaClock() const
+{
+    return audioBuffer_.getMediaClock();
+}
+
 void QtAudioOutput::onStartPlayback()
 {
     if(!playbackStarted_)
     {
-        audioBuffer_ = audioOutput_->start();
+        // Pull mode: the audio device asks for exactly what it needs, so the
+        // jitter buffer decides what it gets, silence included.
+        audioOutput_->start(&audioBuffer_);
         playbackStarted_ = true;
     }
     else
@@ -124,6 +234,7 @@ void QtAudioOutput::onStopPlayback()
     if(playbackStarted_)
     {
         audioOutput_->stop();
+        audioBuffer_.flush();
         playbackStarted_ = false;
     }
 }
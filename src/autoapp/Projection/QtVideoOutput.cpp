@@ -96,7 +96,8 @@ QtVideoOutput::QtVideoOutput(configuration::IConfiguration::Pointer configuratio
     this->moveToThread(QApplication::instance()->thread());
     connect(this, &QtVideoOutput::startPlayback, this, &QtVideoOutput::onStartPlayback, Qt::QueuedConnection);
     connect(this, &QtVideoOutput::stopPlayback, this, &QtVideoOutput::onStopPlayback, Qt::QueuedConnection);
-    QMetaObject::invokeMethod(this, "createVideoOutput", Qt::BlockingQueuedConnection);
+    // Don't hold the caller up while the widgets are built; open() waits for them.
+    QMetaObject::invokeMethod(this, "createVideoOutput", Qt::QueuedConnection);
 }
 
 void QtVideoOutput::createVideoOutput()
@@ -104,11 +105,13 @@ void QtVideoOutput::createVideoOutput()
     OPENAUTO_LOG(debug) << "[QtVideoOutput] create.";
     videoWidget_ = std::make_unique<QVideoWidget>();
     mediaPlayer_ = std::make_unique<QMediaPlayer>(nullptr, QMediaPlayer::StreamPlayback);
+    created_.open();
 }
 
 
 bool QtVideoOutput::open()
 {
+    created_.wait();
     return videoBuffer_.open(QIODevice::ReadWrite);
 }
 
@@ -19,6 +19,8 @@
 
 #ifdef USE_GSTREAMER
 
+#include <algorithm>
+
 #include <gst/gst.h>
 #include <gst/gstdebugutils.h>
 
@@ -40,18 +42,35 @@ namespace autoapp
 namespace projection
 {
 
-QuickGstVideoOutput::QuickGstVideoOutput(configuration::IConfiguration::Pointer configuration)
+// Enough to cover frames sitting in appsrc and decodebin3's input queue.
+static constexpr size_t cMaxFreeBuffers = 16;
+
+QuickGstVideoOutput::QuickGstVideoOutput(configuration::IConfiguration::Pointer configuration, bool headless)
     : VideoOutput(std::move(configuration))
+    , bufferPool_(VideoBufferPool::create(cMaxFreeBuffers))
+    , headless_(headless)
+    , quickView_(nullptr)
     , videoItem_(nullptr)
     , onGstMessageHandlerId(0)
+    , framesPushed_(0)
+    , framesToDecoder_(0)
+    , ptsAnchored_(false)
+    , ptsOffset_(0)
 {
     this->moveToThread(QApplication::instance()->thread());
     connect(this, &QuickGstVideoOutput::startPlayback, this, &QuickGstVideoOutput::onStartPlayback, Qt::QueuedConnection);
     connect(this, &QuickGstVideoOutput::stopPlayback, this, &QuickGstVideoOutput::onStopPlayback, Qt::QueuedConnection);
-    QMetaObject::invokeMethod(this, "createVideoOutput", Qt::BlockingQueuedConnection);
+    // Don't hold the caller up while the pipeline is built; open() waits for it.
+    QMetaObject::invokeMethod(this, "createVideoOutput", Qt::QueuedConnection);
 }
 
 void QuickGstVideoOutput::createVideoOutput()
+{
+    this->buildVideoOutput();
+    created_.open();
+}
+
+void QuickGstVideoOutput::buildVideoOutput()
 {
     g_autoptr(GError) error = nullptr;
 
@@ -59,9 +78,11 @@ void QuickGstVideoOutput::createVideoOutput()
 
     gst_init(nullptr, nullptr);
 
+    const auto pipelineDescription = this->buildPipelineDescription();
+    OPENAUTO_LOG(info) << "[QuickGstVideoOutput] pipeline: " << pipelineDescription;
+
     gstPipeline_.reset(GST_PIPELINE(gst_parse_launch_full(
-        "appsrc name=appsrc ! decodebin3 ! glupload ! glcolorconvert ! "
-        "qmlglsink name=qmlglsink force-aspect-ratio=false",
+        pipelineDescription.c_str(),
         /* parse context */ nullptr, GST_PARSE_FLAG_FATAL_ERRORS, &error)));
     if (!gstPipeline_ || error) {
         OPENAUTO_LOG(error) << "[QuickGstVideoOutput] fails to create Gst pipeline: "
@@ -79,13 +100,31 @@ void QuickGstVideoOutput::createVideoOutput()
     }
 
     appsrc_.reset(GST_APP_SRC(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "appsrc")));
-    qmlglsink_.reset(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "qmlglsink"));
+    videosink_.reset(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "videosink"));
 
-    if (!appsrc_ || !qmlglsink_) {
+    if (!appsrc_ || !videosink_) {
         OPENAUTO_LOG(error) << "[QuickGstVideoOutput] cannot get Gst elements from pipeline?";
         return;
     }
 
+    // Frames carry presentation timestamps, so let the sink schedule them and
+    // drop the ones that arrive too late instead of rendering a backlog.
+    g_object_set(appsrc_.get(),
+        "format", GST_FORMAT_TIME,
+        "is-live", TRUE,
+        "do-timestamp", FALSE,
+        NULL);
+
+    g_object_set(videosink_.get(), "sync", configuration_->getVideoGstSync() ? TRUE : FALSE, NULL);
+
+    this->configureDecoder();
+    this->installLatencyProbes();
+    this->installQueueProbe();
+
+    if (headless_) {
+        return;
+    }
+
     quickView_ = new QQuickView();
     quickView_->setResizeMode(QQuickView::SizeRootObjectToView);
     quickView_->setSource(QUrl("qrc:/QuickGstVideoOutput.qml"));
@@ -95,7 +134,7 @@ void QuickGstVideoOutput::createVideoOutput()
         return;
     }
 
-    g_object_set(qmlglsink_.get(), "widget", videoItem_, NULL);
+    g_object_set(videosink_.get(), "widget", videoItem_, NULL);
 
     // "The container takes over ownership of window."
     widgetWrapper_.reset(QWidget::createWindowContainer(quickView_));
@@ -107,11 +146,13 @@ QuickGstVideoOutput::~QuickGstVideoOutput()
 
 bool QuickGstVideoOutput::open()
 {
-    return true;
+    created_.wait();
+    return appsrc_ != nullptr;
 }
 
 bool QuickGstVideoOutput::init()
 {
+    ptsAnchored_ = false;
     emit startPlayback();
     return true;
 }
@@ -121,13 +162,33 @@ void QuickGstVideoOutput::write(uint64_t timestamp, const aasdk::common::DataCon
     if (!appsrc_)
         return;
 
-    auto gstBuffer = gst_buffer_new_memdup(buffer.cdata, buffer.size);
+    // aasdk only lends us the payload for the duration of this call, so it has
+    // to be copied once. Copy it into a recycled buffer instead of duplicating
+    // it again with memdup.
+    this->writeFrame(timestamp, bufferPool_->acquire(buffer));
+}
+
+void QuickGstVideoOutput::writeFrame(uint64_t timestamp, VideoBufferPool::Buffer frame)
+{
+    if (!appsrc_)
+        return;
+
+    // GStreamer holds a reference to the frame, which goes back to its pool
+    // once decodebin3 releases the last GstMemory.
+    auto data = new VideoBufferPool::Buffer(std::move(frame));
+    auto gstBuffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+        (*data)->data(), (*data)->size(), 0, (*data)->size(),
+        data, &QuickGstVideoOutput::releaseBuffer);
+    GST_BUFFER_PTS(gstBuffer) = this->toRunningTime(timestamp);
 
     // The document seems to infer that it's safe to push the buffer from
     // arbitrary thread.
     // FIXME: it's not clear if we have to wait for the appsrc to be in certain
     // state before we can start pushing data.
-    gst_app_src_push_buffer(appsrc_.get(), gstBuffer);
+    if (gst_app_src_push_buffer(appsrc_.get(), gstBuffer) == GST_FLOW_OK) {
+        ++framesPushed_;
+    }
+    latencyTracer_->record(VideoLatencyTracer::Stage::ENQUEUED, timestamp);
 }
 
 void QuickGstVideoOutput::stop()
@@ -135,9 +196,24 @@ void QuickGstVideoOutput::stop()
     emit stopPlayback();
 }
 
+size_t QuickGstVideoOutput::getQueueDepth() const
+{
+    const uint64_t pushed = framesPushed_;
+    const uint64_t toDecoder = framesToDecoder_;
+    return pushed > toDecoder ? static_cast<size_t>(pushed - toDecoder) : 0;
+}
+
 void QuickGstVideoOutput::onStartPlayback()
 {
-    if (!quickView_ || !gstPipeline_)
+    if (!gstPipeline_)
+        return;
+
+    if (headless_) {
+        gst_element_set_state(GST_ELEMENT(gstPipeline_.get()), GST_STATE_PLAYING);
+        return;
+    }
+
+    if (!quickView_)
         return;
 
     // TODO: a configuration to show fullscren or maximized.
@@ -152,11 +228,15 @@ void QuickGstVideoOutput::onStartPlayback()
 
 void QuickGstVideoOutput::onStopPlayback()
 {
-    if (!quickView_ || !gstPipeline_)
+    if (!gstPipeline_ || (!headless_ && !quickView_))
         return;
 
-    widgetWrapper_->hide();
+    if (widgetWrapper_)
+        widgetWrapper_->hide();
     gst_element_set_state(GST_ELEMENT(gstPipeline_.get()), GST_STATE_NULL);
+    // Whatever was still queued went away with the pipeline.
+    framesPushed_ = 0;
+    framesToDecoder_ = 0;
 
     std::unique_ptr<GstBus, GObjectDeleter> bus(gst_pipeline_get_bus(gstPipeline_.get()));
     gst_bus_disable_sync_message_emission(bus.get());
@@ -164,6 +244,220 @@ void QuickGstVideoOutput::onStopPlayback()
     onGstMessageHandlerId = 0;
 }
 
+// Android relies on decodebin3 to find the MediaCodec decoder. Everywhere else
+// the decoder is chosen explicitly so that its latency settings can be tuned,
+// with a leaky queue behind it so that a slow renderer drops decoded frames
+// instead of stalling the decoder.
+std::string QuickGstVideoOutput::buildPipelineDescription() const
+{
+    // Headless runs need neither a GL context nor a display.
+    const std::string sink = headless_
+        ? "fakesink name=videosink"
+        : "glupload name=upload ! glcolorconvert ! qmlglsink name=videosink force-aspect-ratio=false";
+
+#ifdef __ANDROID__
+    return "appsrc name=appsrc ! decodebin3 ! " + sink;
+#else
+    return "appsrc name=appsrc ! h264parse ! "
+           "video/x-h264,stream-format=byte-stream,alignment=au ! "
+           "queue max-size-buffers=8 max-size-bytes=0 max-size-time=0 ! " +
+           selectDecoder(configuration_->getVideoGstDecoder()) + " name=decoder ! "
+           "queue max-size-buffers=2 max-size-bytes=0 max-size-time=0 leaky=downstream ! " +
+           sink;
+#endif
+}
+
+// static
+std::string QuickGstVideoOutput::selectDecoder(const std::string& decoder)
+{
+    if (decoder != "auto") {
+        return decoder;
+    }
+
+    // Stateless and stateful V4L2 codecs cover most SoCs, VA covers Intel and
+    // AMD GPUs; avdec_h264 works everywhere.
+    static const char * const cDecoders[] = {
+        "v4l2slh264dec", "v4l2h264dec", "vah264dec", "vaapih264dec", "avdec_h264"
+    };
+
+    for (const auto name : cDecoders) {
+        std::unique_ptr<GstElementFactory, GObjectDeleter> factory(gst_element_factory_find(name));
+
+        if (factory) {
+            return name;
+        }
+    }
+
+    return "avdec_h264";
+}
+
+// static
+void QuickGstVideoOutput::setPropertyIfExists(GstElement * element, const char * name, const char * value)
+{
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(element), name)) {
+        gst_util_set_object_arg(G_OBJECT(element), name, value);
+    }
+}
+
+void QuickGstVideoOutput::configureDecoder()
+{
+    std::unique_ptr<GstElement, GObjectDeleter> decoder(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "decoder"));
+
+    if (!decoder) {
+        return;
+    }
+
+    // Not a new reference.
+    GstElementFactory * factory = gst_element_get_factory(decoder.get());
+    OPENAUTO_LOG(info) << "[QuickGstVideoOutput] decoder: "
+                       << (factory ? GST_OBJECT_NAME(factory) : "(unknown)");
+
+    // Projection streams have no B-frames, so there is nothing to gain from
+    // waiting for the reorder buffer to fill before outputting a frame.
+    setPropertyIfExists(decoder.get(), "low-latency", "true");
+
+    // Software fallback: spread decoding over all cores with frame threading.
+    setPropertyIfExists(decoder.get(), "max-threads", "0");
+    setPropertyIfExists(decoder.get(), "thread-type", "frame");
+}
+
+// Decoded frames are seen leaving the decoder (or entering glupload where the
+// decoder is hidden inside decodebin3), rendered ones reaching the sink.
+void QuickGstVideoOutput::installLatencyProbes()
+{
+    std::unique_ptr<GstElement, GObjectDeleter> decoder(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "decoder"));
+    std::unique_ptr<GstElement, GObjectDeleter> upload(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "upload"));
+    std::unique_ptr<GstPad, GObjectDeleter> decodedPad(decoder
+        ? gst_element_get_static_pad(decoder.get(), "src")
+        : (upload ? gst_element_get_static_pad(upload.get(), "sink") : nullptr));
+    std::unique_ptr<GstPad, GObjectDeleter> renderedPad(gst_element_get_static_pad(videosink_.get(), "sink"));
+
+    if (decodedPad) {
+        gst_pad_add_probe(decodedPad.get(), GST_PAD_PROBE_TYPE_BUFFER,
+            &QuickGstVideoOutput::onDecodedBuffer, this, nullptr);
+    }
+
+    if (renderedPad) {
+        gst_pad_add_probe(renderedPad.get(), GST_PAD_PROBE_TYPE_BUFFER,
+            &QuickGstVideoOutput::onRenderedBuffer, this, nullptr);
+    }
+}
+
+// Frames are counted as they enter the decoder. Where decodebin3 hides it,
+// they are counted leaving it instead, which includes its own backlog.
+void QuickGstVideoOutput::installQueueProbe()
+{
+    std::unique_ptr<GstElement, GObjectDeleter> decoder(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "decoder"));
+    std::unique_ptr<GstElement, GObjectDeleter> upload(gst_bin_get_by_name(GST_BIN(gstPipeline_.get()), "upload"));
+    std::unique_ptr<GstPad, GObjectDeleter> pad(decoder
+        ? gst_element_get_static_pad(decoder.get(), "sink")
+        : gst_element_get_static_pad(upload ? upload.get() : videosink_.get(), "sink"));
+
+    if (pad) {
+        gst_pad_add_probe(pad.get(), GST_PAD_PROBE_TYPE_BUFFER,
+            &QuickGstVideoOutput::onDecoderInput, this, nullptr);
+    }
+}
+
+// static
+GstPadProbeReturn QuickGstVideoOutput::onDecoderInput(GstPad *, GstPadProbeInfo *, gpointer user_data)
+{
+    ++static_cast<QuickGstVideoOutput *>(user_data)->framesToDecoder_;
+    return GST_PAD_PROBE_OK;
+}
+
+uint64_t QuickGstVideoOutput::toStreamTimestamp(GstClockTime runningTime) const
+{
+    return static_cast<uint64_t>(GST_CLOCK_DIFF(ptsOffset_.load(std::memory_order_acquire), runningTime) / GST_USECOND);
+}
+
+// static
+GstPadProbeReturn QuickGstVideoOutput::onDecodedBuffer(GstPad *, GstPadProbeInfo * info, gpointer user_data)
+{
+    auto self = static_cast<QuickGstVideoOutput *>(user_data);
+    GstBuffer * buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if (self->latencyTracer_->isEnabled() && GST_BUFFER_PTS_IS_VALID(buffer)) {
+        self->latencyTracer_->record(VideoLatencyTracer::Stage::DECODED,
+            self->toStreamTimestamp(GST_BUFFER_PTS(buffer)));
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+// The sink holds a frame until its running time comes up, so with sync on
+// the frame is shown after whatever is left of that wait.
+// static
+GstPadProbeReturn QuickGstVideoOutput::onRenderedBuffer(GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+    auto self = static_cast<QuickGstVideoOutput *>(user_data);
+    GstBuffer * buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if (!self->latencyTracer_->isEnabled() || !GST_BUFFER_PTS_IS_VALID(buffer)) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstClockTimeDiff wait = 0;
+    std::unique_ptr<GstElement, GObjectDeleter> sink(gst_pad_get_parent_element(pad));
+    gboolean sync = FALSE;
+
+    if (sink) {
+        g_object_get(sink.get(), "sync", &sync, NULL);
+    }
+
+    if (sink && sync) {
+        if (GstClock * clock = gst_element_get_clock(sink.get())) {
+            const auto now = GST_CLOCK_DIFF(gst_element_get_base_time(sink.get()), gst_clock_get_time(clock));
+            wait = std::max<GstClockTimeDiff>(GST_CLOCK_DIFF(now, GST_BUFFER_PTS(buffer)), 0);
+            gst_object_unref(clock);
+        }
+    }
+
+    self->latencyTracer_->record(VideoLatencyTracer::Stage::RENDERED,
+        self->toStreamTimestamp(GST_BUFFER_PTS(buffer)), wait / GST_USECOND);
+
+    return GST_PAD_PROBE_OK;
+}
+
+// Maps a stream presentation timestamp (microseconds) to pipeline running
+// time, anchored so that the first frame is due as soon as it arrives. Until
+// the pipeline is PLAYING there is no clock to anchor on; those frames go out
+// without a timestamp and are shown as soon as they are decoded, rather than
+// carrying the startup gap over into every later frame.
+GstClockTime QuickGstVideoOutput::toRunningTime(uint64_t timestamp)
+{
+    const GstClockTimeDiff pts = static_cast<GstClockTimeDiff>(timestamp * GST_USECOND);
+
+    if (!ptsAnchored_.load(std::memory_order_acquire)) {
+        GstElement * pipeline = GST_ELEMENT(gstPipeline_.get());
+        GstState state = GST_STATE_NULL;
+        gst_element_get_state(pipeline, &state, nullptr, 0);
+
+        // A pipeline that played before keeps its old clock and base time.
+        GstClock * clock = state == GST_STATE_PLAYING ? gst_element_get_clock(pipeline) : nullptr;
+        if (clock == nullptr) {
+            return GST_CLOCK_TIME_NONE;
+        }
+
+        const GstClockTime baseTime = gst_element_get_base_time(pipeline);
+        const GstClockTimeDiff runningTime = GST_CLOCK_DIFF(baseTime, gst_clock_get_time(clock));
+        gst_object_unref(clock);
+
+        ptsOffset_.store(runningTime - pts, std::memory_order_relaxed);
+        ptsAnchored_.store(true, std::memory_order_release);
+    }
+
+    return static_cast<GstClockTime>(std::max<GstClockTimeDiff>(pts + ptsOffset_.load(std::memory_order_relaxed), 0));
+}
+
+// Called from whatever streaming thread drops the last reference to the
+// GstMemory wrapping our buffer.
+// static
+void QuickGstVideoOutput::releaseBuffer(gpointer user_data)
+{
+    delete static_cast<VideoBufferPool::Buffer *>(user_data);
+}
+
 // Called from whatever thread emitting this message. Right now we only log the
 // error, but for any serious handling we'll probably want to post a message to
 // Qt main thread.
@@ -0,0 +1,164 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <f1x/openauto/autoapp/Projection/RingBuffer.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+RingBuffer::RingBuffer(size_t capacity)
+    : data_(roundUpToPowerOfTwo(capacity))
+    , mask_(data_.size() - 1)
+    , locked_(false)
+    , writeIndex_(0)
+    , readIndex_(0)
+{
+}
+
+RingBuffer::~RingBuffer()
+{
+    if(locked_)
+    {
+        munlock(data_.data(), data_.size());
+    }
+}
+
+size_t RingBuffer::write(const char* data, size_t len)
+{
+    // Indices run freely and are only masked when touching data_, so
+    // writeIndex - readIndex is always the number of bytes stored.
+    const auto writeIndex = writeIndex_.load(std::memory_order_relaxed);
+    const auto readIndex = readIndex_.load(std::memory_order_acquire);
+
+    len = std::min(len, data_.size() - (writeIndex - readIndex));
+
+    const auto offset = writeIndex & mask_;
+    const auto firstChunk = std::min(len, data_.size() - offset);
+    memcpy(&data_[offset], data, firstChunk);
+    memcpy(&data_[0], data + firstChunk, len - firstChunk);
+
+    writeIndex_.store(writeIndex + len, std::memory_order_release);
+    return len;
+}
+
+size_t RingBuffer::read(char* data, size_t len)
+{
+    const auto readIndex = readIndex_.load(std::memory_order_relaxed);
+    const auto writeIndex = writeIndex_.load(std::memory_order_acquire);
+
+    len = std::min(len, writeIndex - readIndex);
+
+    const auto offset = readIndex & mask_;
+    const auto firstChunk = std::min(len, data_.size() - offset);
+    memcpy(data, &data_[offset], firstChunk);
+    memcpy(data + firstChunk, &data_[0], len - firstChunk);
+
+    readIndex_.store(readIndex + len, std::memory_order_release);
+    return len;
+}
+
+size_t RingBuffer::skip(size_t len)
+{
+    const auto readIndex = readIndex_.load(std::memory_order_relaxed);
+    const auto writeIndex = writeIndex_.load(std::memory_order_acquire);
+
+    len = std::min(len, writeIndex - readIndex);
+    readIndex_.store(readIndex + len, std::memory_order_release);
+    return len;
+}
+
+void RingBuffer::clear()
+{
+    readIndex_.store(writeIndex_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void RingBuffer::reset(size_t capacity)
+{
+    const bool locked = locked_;
+
+    if(locked_)
+    {
+        munlock(data_.data(), data_.size());
+        locked_ = false;
+    }
+
+    // Zero-filling the new storage also faults every page in up front.
+    std::vector<char>(roundUpToPowerOfTwo(capacity), 0).swap(data_);
+    mask_ = data_.size() - 1;
+    writeIndex_.store(0, std::memory_order_relaxed);
+    readIndex_.store(0, std::memory_order_relaxed);
+
+    if(locked)
+    {
+        this->lock();
+    }
+}
+
+bool RingBuffer::lock()
+{
+    locked_ = locked_ || mlock(data_.data(), data_.size()) == 0;
+    return locked_;
+}
+
+size_t RingBuffer::size() const
+{
+    const auto readIndex = readIndex_.load(std::memory_order_acquire);
+    return writeIndex_.load(std::memory_order_acquire) - readIndex;
+}
+
+size_t RingBuffer::capacity() const
+{
+    return data_.size();
+}
+
+size_t RingBuffer::writePosition() const
+{
+    return writeIndex_.load(std::memory_order_acquire);
+}
+
+size_t RingBuffer::readPosition() const
+{
+    return readIndex_.load(std::memory_order_acquire);
+}
+
+size_t RingBuffer::roundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+
+    while(result < value)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+}
+}
+}
+}
@@ -28,10 +28,11 @@ namespace autoapp
 namespace projection
 {
 
-RtAudioOutput::RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+RtAudioOutput::RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency)
     : channelCount_(channelCount)
     , sampleSize_(sampleSize)
     , sampleRate_(sampleRate)
+    , audioBuffer_(channelCount, sampleSize, sampleRate, targetLatency)
 {
     std::vector<RtAudio::Api> apis;
     RtAudio::getCompiledApi(apis);
@@ -72,6 +73,12 @@ bool RtAudioOutput::open()
     #endif
 
         OPENAUTO_LOG(info) << "[RtAudioOutput] Sample Rate: " << sampleRate_;
+
+        if(!audioBuffer_.lockMemory())
+        {
+            OPENAUTO_LOG(warning) << "[RtAudioOutput] Failed to lock audio buffer in memory, playback may glitch under memory pressure.";
+        }
+
         return audioBuffer_.open(QIODevice::ReadWrite);
     }
     else
@@ -84,7 +91,7 @@ bool RtAudioOutput::open()
 
 void RtAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+    audioBuffer_.push(reinterpret_cast<const char*>(buffer.cdata), buffer.size, timestamp);
 }
 
 void RtAudioOutput::start()
@@ -122,11 +129,23 @@ void RtAudioOutput::stop()
     {
         dac_->closeStream();
     }
+
+    audioBuffer_.flush();
 }
 
 void RtAudioOutput::suspend()
 {
-    //not needed
+    audioBuffer_.endOfStream();
+}
+
+void RtAudioOutput::flush()
+{
+    audioBuffer_.requestFlush();
+}
+
+void RtAudioOutput::setGain(float gain)
+{
+    audioBuffer_.setGain(gain);
 }
 
 uint32_t RtAudioOutput::getSampleSize() const
@@ -144,6 +163,82 @@ uint32_t RtAudioOutput::getSampleRate() const
     return sampleRate_;
 }
 
+std::vector<AudioFormat> RtAudioOutput::getSupportedFormats() const
+{
+    std::vector<AudioFormat> formats;
+
+    if(dac_->getDeviceCount() == 0)
+    {
+        return formats;
+    }
+
+#if RTAUDIO_VERSION_MAJOR >= 6
+    const auto info = dac_->getDeviceInfo(dac_->getDefaultOutputDevice());
+#else
+    RtAudio::DeviceInfo info;
+    try
+    {
+        info = dac_->getDeviceInfo(dac_->getDefaultOutputDevice());
+    }
+    catch(const RtAudioError& e)
+    {
+        OPENAUTO_LOG(error) << "[RtAudioOutput] Failed to query audio output, what: " << e.what();
+        return formats;
+    }
+#endif
+
+    if(info.outputChannels < channelCount_)
+    {
+        return formats;
+    }
+
+    auto sampleRates = info.sampleRates;
+    std::stable_partition(sampleRates.begin(), sampleRates.end(), [&](unsigned int sampleRate) { return sampleRate == info.preferredSampleRate; });
+
+    for(const auto sampleRate : sampleRates)
+    {
+        AudioFormat format;
+        format.sampleRate = sampleRate;
+        format.sampleSize = 16;
+        format.channelCount = channelCount_;
+        formats.push_back(format);
+    }
+
+    return formats;
+}
+
+bool RtAudioOutput::setFormat(const AudioFormat& format)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(dac_->isStreamOpen())
+    {
+        return false;
+    }
+
+    // The stream is always opened as RTAUDIO_SINT16.
+    if(format.sampleSize != 16)
+    {
+        return false;
+    }
+
+    channelCount_ = format.channelCount;
+    sampleSize_ = format.sampleSize;
+    sampleRate_ = format.sampleRate;
+    audioBuffer_.setFormat(channelCount_, sampleSize_, sampleRate_);
+    return true;
+}
+
+AudioBufferStats RtAudioOutput::getBufferStats() const
+{
+    return audioBuffer_.getStats();
+}
+
+MediaClock::Pointer RtAudioOutput::getMediaClock() const
+{
+    return audioBuffer_.getMediaClock();
+}
+
 void RtAudioOutput::doSuspend()
 {
     if(dac_->isStreamOpen() && dac_->isStreamRunning())
@@ -170,11 +265,12 @@ void RtAudioOutput::doSuspend()
 int RtAudioOutput::audioBufferReadHandler(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
                                           double streamTime, RtAudioStreamStatus status, void* userData)
 {
+    // Runs on RtAudio's real-time thread, so no locks here: the format is only
+    // changed while the stream is closed, stopStream() waits for a running
+    // callback to return, and flushes are handed over through the buffer.
     RtAudioOutput* self = static_cast<RtAudioOutput*>(userData);
-    std::lock_guard<decltype(self->mutex_)> lock(self->mutex_);
-
     const auto bufferSize = nBufferFrames * (self->sampleSize_ / 8) * self->channelCount_;
-    self->audioBuffer_.read(reinterpret_cast<char*>(outputBuffer), bufferSize);
+    self->audioBuffer_.pull(reinterpret_cast<char*>(outputBuffer), bufferSize);
     return 0;
 }
 
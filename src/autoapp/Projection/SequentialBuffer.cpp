@@ -17,6 +17,7 @@
 */
 
 #include <f1x/openauto/autoapp/Projection/SequentialBuffer.hpp>
+#include <f1x/openauto/Common/Log.hpp>
 
 namespace f1x
 {
@@ -27,8 +28,13 @@ namespace autoapp
 namespace projection
 {
 
-SequentialBuffer::SequentialBuffer()
-    : data_(aasdk::common::cStaticDataSize)
+// A stalled reader drops every frame; one line per this many is enough.
+static constexpr uint64_t cDropLogInterval = 100;
+
+SequentialBuffer::SequentialBuffer(size_t capacity)
+    : data_(capacity)
+    , readyReadPending_(false)
+    , droppedWrites_(0)
 {
 }
 
@@ -39,34 +45,45 @@ bool SequentialBuffer::isSequential() const
 
 bool SequentialBuffer::open(OpenMode mode)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
-
-    return QIODevice::open(mode);
+    // The ring buffer already is the buffer; QIODevice's own read buffer
+    // would only add a second copy that isn't safe across threads.
+    return QIODevice::open(mode | QIODevice::Unbuffered);
 }
 
 qint64 SequentialBuffer::readData(char *data, qint64 maxlen)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    // Re-arm the notification before draining so that data written after
+    // this point is announced again.
+    readyReadPending_.store(false, std::memory_order_release);
+
+    return data_.read(data, maxlen);
+}
 
-    if(data_.empty())
+qint64 SequentialBuffer::writeData(const char *data, qint64 len)
+{
+    // The reader can only free space meanwhile, so this check never lets
+    // through a write that would then be cut short.
+    if(static_cast<size_t>(len) > data_.capacity() - data_.size())
     {
+        if(droppedWrites_++ % cDropLogInterval == 0)
+        {
+            OPENAUTO_LOG(warning) << "[SequentialBuffer] buffer full, dropping write of " << len
+                                  << " bytes, dropped so far: " << droppedWrites_;
+        }
+
         return 0;
     }
 
-    const auto len = std::min<size_t>(maxlen, data_.size());
-    std::copy(data_.begin(), data_.begin() + len, data);
-    data_.erase_begin(len);
+    const auto written = data_.write(data, len);
 
-    return len;
-}
-
-qint64 SequentialBuffer::writeData(const char *data, qint64 len)
-{
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    // One readyRead per batch: the reader drains everything available when it
+    // is notified, so further writes until its next read need no signal.
+    if(written > 0 && !readyReadPending_.exchange(true, std::memory_order_acq_rel))
+    {
+        emit readyRead();
+    }
 
-    data_.insert(data_.end(), data, data + len);
-    emit readyRead();
-    return len;
+    return written;
 }
 
 qint64 SequentialBuffer::size() const
@@ -93,13 +110,12 @@ bool SequentialBuffer::atEnd() const
 bool SequentialBuffer::reset()
 {
     data_.clear();
+    readyReadPending_.store(false, std::memory_order_release);
     return true;
 }
 
 qint64 SequentialBuffer::bytesAvailable() const
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
-
     return QIODevice::bytesAvailable() + std::max<qint64>(1, data_.size());
 }
 
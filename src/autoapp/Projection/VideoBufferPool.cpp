@@ -0,0 +1,94 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <f1x/openauto/autoapp/Projection/VideoBufferPool.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+VideoBufferPool::VideoBufferPool(size_t maxFreeBuffers)
+    : maxFreeBuffers_(maxFreeBuffers)
+{
+    freeBuffers_.reserve(maxFreeBuffers_);
+}
+
+VideoBufferPool::Pointer VideoBufferPool::create(size_t maxFreeBuffers)
+{
+    return Pointer(new VideoBufferPool(maxFreeBuffers));
+}
+
+VideoBufferPool::Buffer VideoBufferPool::acquire(const aasdk::common::DataConstBuffer& source)
+{
+    std::unique_ptr<aasdk::common::Data> data;
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+        if(!freeBuffers_.empty())
+        {
+            data = std::move(freeBuffers_.back());
+            freeBuffers_.pop_back();
+        }
+    }
+
+    if(data == nullptr)
+    {
+        data = std::make_unique<aasdk::common::Data>();
+    }
+
+    // assign() keeps the capacity of a recycled buffer, so once the pool has
+    // seen the largest frame of the stream this is a plain memcpy.
+    data->assign(source.cdata, source.cdata + source.size);
+
+    // The buffer may outlive the pool, e.g. when the decoder drops its last
+    // reference after the video output is gone.
+    std::weak_ptr<VideoBufferPool> weakSelf(this->shared_from_this());
+    return Buffer(data.release(), [weakSelf](aasdk::common::Data* data) {
+        if(auto self = weakSelf.lock())
+        {
+            self->release(data);
+        }
+        else
+        {
+            delete data;
+        }
+    });
+}
+
+void VideoBufferPool::release(aasdk::common::Data* data)
+{
+    std::unique_ptr<aasdk::common::Data> buffer(data);
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(freeBuffers_.size() < maxFreeBuffers_)
+    {
+        freeBuffers_.push_back(std::move(buffer));
+    }
+}
+
+}
+}
+}
+}
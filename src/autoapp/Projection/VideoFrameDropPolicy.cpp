@@ -0,0 +1,115 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/H264FrameInfo.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoFrameDropPolicy.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+constexpr uint32_t VideoFrameDropPolicy::cMaxSkippedFrames;
+
+VideoFrameDropPolicy::VideoFrameDropPolicy(size_t threshold)
+    : threshold_(threshold)
+    , waitingForIdr_(false)
+    , keyframeRequested_(false)
+    , skippedFrames_(0)
+    , droppedFrames_(0)
+{
+
+}
+
+bool VideoFrameDropPolicy::shouldDrop(const aasdk::common::DataConstBuffer& buffer, size_t queueDepth)
+{
+    if(threshold_ == 0 || (!waitingForIdr_ && queueDepth < threshold_))
+    {
+        return false;
+    }
+
+    const auto frame = parseH264Frame(buffer);
+
+    if(frame.hasParameterSets || !frame.hasSlices)
+    {
+        return false;
+    }
+
+    if(frame.isIdr)
+    {
+        if(waitingForIdr_)
+        {
+            OPENAUTO_LOG(info) << "[VideoFrameDropPolicy] resynchronized on IDR, dropped frames: " << droppedFrames_;
+            waitingForIdr_ = false;
+        }
+
+        return false;
+    }
+
+    if(!waitingForIdr_ && queueDepth >= threshold_ * 2)
+    {
+        OPENAUTO_LOG(info) << "[VideoFrameDropPolicy] decoder queue depth " << queueDepth << ", skipping to next IDR.";
+        waitingForIdr_ = true;
+        keyframeRequested_ = true;
+        skippedFrames_ = 0;
+    }
+
+    if(waitingForIdr_ && ++skippedFrames_ > cMaxSkippedFrames)
+    {
+        OPENAUTO_LOG(warning) << "[VideoFrameDropPolicy] no IDR within " << cMaxSkippedFrames << " frames, requesting one again.";
+        keyframeRequested_ = true;
+        skippedFrames_ = 0;
+    }
+
+    if(waitingForIdr_ || !frame.isReference)
+    {
+        ++droppedFrames_;
+        return true;
+    }
+
+    return false;
+}
+
+bool VideoFrameDropPolicy::takeKeyframeRequest()
+{
+    const bool requested = keyframeRequested_;
+    keyframeRequested_ = false;
+    return requested;
+}
+
+void VideoFrameDropPolicy::reset()
+{
+    waitingForIdr_ = false;
+    keyframeRequested_ = false;
+}
+
+uint64_t VideoFrameDropPolicy::getDroppedFrames() const
+{
+    return droppedFrames_;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,251 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstring>
+#include <iterator>
+#include <f1x/openauto/Common/Log.hpp>
+#include <f1x/openauto/Common/LittleEndian.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoFrameLog.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+const char cMagic[] = {'O', 'A', 'V', 'F'};
+const uint32_t cVersion = 1;
+// Anything bigger than this is a corrupt record rather than a frame.
+const uint32_t cMaxFrameSize = 16 * 1024 * 1024;
+
+size_t findStartCode(const aasdk::common::Data& data, size_t offset)
+{
+    for(size_t i = offset; i + 2 < data.size(); ++i)
+    {
+        if(data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+        {
+            return i;
+        }
+    }
+
+    return data.size();
+}
+
+}
+
+bool VideoFrameLogWriter::open(const std::string& path)
+{
+    file_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!file_.is_open())
+    {
+        OPENAUTO_LOG(error) << "[VideoFrameLogWriter] cannot open " << path;
+        return false;
+    }
+
+    file_.write(cMagic, sizeof(cMagic));
+    common::writeLittleEndian<uint32_t>(file_, cVersion);
+    started_ = false;
+
+    OPENAUTO_LOG(info) << "[VideoFrameLogWriter] capturing video to " << path;
+    return true;
+}
+
+void VideoFrameLogWriter::write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    if(!started_)
+    {
+        started_ = true;
+        start_ = now;
+    }
+
+    common::writeLittleEndian<uint64_t>(file_, std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count());
+    common::writeLittleEndian<uint64_t>(file_, timestamp);
+    common::writeLittleEndian<uint32_t>(file_, static_cast<uint32_t>(buffer.size));
+    file_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+
+    if(!file_)
+    {
+        OPENAUTO_LOG(error) << "[VideoFrameLogWriter] write failed, capture stopped.";
+        file_.close();
+    }
+}
+
+void VideoFrameLogWriter::close()
+{
+    if(file_.is_open())
+    {
+        file_.close();
+    }
+}
+
+bool VideoFrameLogWriter::isOpen() const
+{
+    return file_.is_open();
+}
+
+bool VideoFrameLogReader::open(const std::string& path, uint64_t frameInterval)
+{
+    file_.open(path, std::ios::in | std::ios::binary);
+
+    if(!file_.is_open())
+    {
+        OPENAUTO_LOG(error) << "[VideoFrameLogReader] cannot open " << path;
+        return false;
+    }
+
+    frameInterval_ = frameInterval;
+    frameCount_ = 0;
+
+    char magic[sizeof(cMagic)] = {};
+    uint32_t version = 0;
+    if(file_.read(magic, sizeof(magic)) && std::memcmp(magic, cMagic, sizeof(cMagic)) == 0)
+    {
+        if(!common::readLittleEndian(file_, version) || version != cVersion)
+        {
+            OPENAUTO_LOG(error) << "[VideoFrameLogReader] unsupported log version " << version;
+            return false;
+        }
+
+        annexB_ = false;
+        return true;
+    }
+
+    // No header, so treat the whole file as an elementary stream.
+    file_.clear();
+    file_.seekg(0);
+    annexBData_.assign(std::istreambuf_iterator<char>(file_), std::istreambuf_iterator<char>());
+    annexBOffset_ = findStartCode(annexBData_, 0);
+    annexB_ = true;
+
+    if(annexBOffset_ == annexBData_.size())
+    {
+        OPENAUTO_LOG(error) << "[VideoFrameLogReader] " << path << " is neither a frame log nor an Annex-B stream.";
+        return false;
+    }
+
+    return true;
+}
+
+bool VideoFrameLogReader::read(VideoFrameRecord& record)
+{
+    if(annexB_)
+    {
+        return this->readAnnexB(record);
+    }
+
+    uint32_t size = 0;
+    if(!common::readLittleEndian(file_, record.arrivalTime) || !common::readLittleEndian(file_, record.timestamp) || !common::readLittleEndian(file_, size))
+    {
+        return false;
+    }
+
+    if(size > cMaxFrameSize)
+    {
+        OPENAUTO_LOG(error) << "[VideoFrameLogReader] corrupt record, frame size: " << size;
+        return false;
+    }
+
+    record.payload.resize(size);
+    if(!file_.read(reinterpret_cast<char*>(record.payload.data()), size))
+    {
+        OPENAUTO_LOG(error) << "[VideoFrameLogReader] truncated record.";
+        return false;
+    }
+
+    ++frameCount_;
+    return true;
+}
+
+bool VideoFrameLogReader::isAnnexB() const
+{
+    return annexB_;
+}
+
+bool VideoFrameLogReader::readAnnexB(VideoFrameRecord& record)
+{
+    if(annexBOffset_ >= annexBData_.size())
+    {
+        return false;
+    }
+
+    const auto end = this->findNextAccessUnit(annexBOffset_);
+    record.payload.assign(annexBData_.begin() + annexBOffset_, annexBData_.begin() + end);
+    record.arrivalTime = frameCount_ * frameInterval_;
+    record.timestamp = 0;
+
+    annexBOffset_ = end;
+    ++frameCount_;
+    return true;
+}
+
+size_t VideoFrameLogReader::findNextAccessUnit(size_t offset) const
+{
+    enum
+    {
+        cNalSlice = 1,
+        cNalIdrSlice = 5,
+        cNalSei = 6,
+        cNalSps = 7,
+        cNalPps = 8,
+        cNalAud = 9
+    };
+
+    bool hasSlices = false;
+
+    // The phone sends one access unit per message: parameter sets and SEI go
+    // with the picture that follows them, and a picture starts at the slice
+    // whose first_mb_in_slice is 0 (a leading 1 bit in its Exp-Golomb code).
+    for(auto position = findStartCode(annexBData_, offset); position < annexBData_.size(); position = findStartCode(annexBData_, position + 3))
+    {
+        const auto headerPosition = position + 3;
+        if(headerPosition >= annexBData_.size())
+        {
+            break;
+        }
+
+        const auto type = annexBData_[headerPosition] & 0x1f;
+        const bool isSlice = type == cNalSlice || type == cNalIdrSlice;
+        const bool startsPicture = isSlice && headerPosition + 1 < annexBData_.size() && (annexBData_[headerPosition + 1] & 0x80) != 0;
+        const bool startsPrefix = type == cNalSei || type == cNalSps || type == cNalPps || type == cNalAud;
+
+        if(hasSlices && (startsPicture || startsPrefix))
+        {
+            // Keep the leading zero of a four byte start code with its unit.
+            return position > offset && annexBData_[position - 1] == 0 ? position - 1 : position;
+        }
+
+        hasSlices = hasSlices || isSlice;
+    }
+
+    return annexBData_.size();
+}
+
+}
+}
+}
+}
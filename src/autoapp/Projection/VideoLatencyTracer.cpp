@@ -0,0 +1,143 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <chrono>
+#include <f1x/openauto/autoapp/Projection/VideoLatencyTracer.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+VideoLatencyTracer::VideoLatencyTracer(bool enabled)
+    : enabled_(enabled)
+{
+    this->reset();
+}
+
+bool VideoLatencyTracer::isEnabled() const
+{
+    return enabled_;
+}
+
+void VideoLatencyTracer::record(Stage stage, uint64_t timestamp)
+{
+    this->record(stage, timestamp, 0);
+}
+
+void VideoLatencyTracer::record(Stage stage, uint64_t timestamp, uint64_t delay)
+{
+    if(!enabled_)
+    {
+        return;
+    }
+
+    const auto time = now() + delay;
+    // Only a handful of frames are in flight at once, so a small table
+    // indexed by timestamp is enough; a stale slot just fails the match.
+    auto& frame = frames_[timestamp % cFrameSlots];
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(stage == Stage::RECEIVED)
+    {
+        frame.timestamp = timestamp;
+        frame.receiveTime = time;
+    }
+    else if(frame.timestamp == timestamp && frame.receiveTime != 0 && time >= frame.receiveTime)
+    {
+        histograms_[static_cast<size_t>(stage)].record(time - frame.receiveTime);
+    }
+}
+
+void VideoLatencyTracer::dump() const
+{
+    if(!enabled_)
+    {
+        return;
+    }
+
+    for(size_t i = static_cast<size_t>(Stage::ENQUEUED); i < cStageCount; ++i)
+    {
+        const auto& histogram = histograms_[i];
+
+        if(histogram.getCount() == 0)
+        {
+            continue;
+        }
+
+        OPENAUTO_LOG(info) << "[VideoLatencyTracer] received -> " << stageName(static_cast<Stage>(i))
+                           << ", frames: " << histogram.getCount()
+                           << ", p50: " << histogram.getPercentile(50) << "us"
+                           << ", p95: " << histogram.getPercentile(95) << "us"
+                           << ", p99: " << histogram.getPercentile(99) << "us";
+    }
+}
+
+uint64_t VideoLatencyTracer::getFrameCount(Stage stage) const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return histograms_[static_cast<size_t>(stage)].getCount();
+}
+
+void VideoLatencyTracer::reset()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    frames_.fill(Frame{0, 0});
+
+    for(auto& histogram : histograms_)
+    {
+        histogram.reset();
+    }
+}
+
+uint64_t VideoLatencyTracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* VideoLatencyTracer::stageName(Stage stage)
+{
+    switch(stage)
+    {
+    case Stage::RECEIVED:
+        return "received";
+    case Stage::ENQUEUED:
+        return "enqueued";
+    case Stage::DECODER_INPUT:
+        return "decoder input";
+    case Stage::DECODED:
+        return "decoded";
+    case Stage::RENDERED:
+        return "rendered";
+    }
+
+    return "unknown";
+}
+
+}
+}
+}
+}
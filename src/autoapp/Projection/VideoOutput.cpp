@@ -29,6 +29,7 @@ namespace projection
 
 VideoOutput::VideoOutput(configuration::IConfiguration::Pointer configuration)
     : configuration_(std::move(configuration))
+    , latencyTracer_(std::make_shared<VideoLatencyTracer>(false))
 {
 
 }
@@ -53,6 +54,22 @@ QRect VideoOutput::getVideoMargins() const
     return configuration_->getVideoMargins();
 }
 
+size_t VideoOutput::getQueueDepth() const
+{
+    // Backends that can't tell are assumed to keep up.
+    return 0;
+}
+
+void VideoOutput::writeFrame(uint64_t timestamp, VideoBufferPool::Buffer frame)
+{
+    this->write(timestamp, aasdk::common::DataConstBuffer(frame->data(), frame->size()));
+}
+
+void VideoOutput::setLatencyTracer(VideoLatencyTracer::Pointer latencyTracer)
+{
+    latencyTracer_ = std::move(latencyTracer);
+}
+
 }
 }
 }
@@ -34,17 +34,23 @@ AndroidAutoEntity::AndroidAutoEntity(boost::asio::io_service& ioService,
                                      aasdk::transport::ITransport::Pointer transport,
                                      aasdk::messenger::IMessenger::Pointer messenger,
                                      configuration::IConfiguration::Pointer configuration,
-                                     ServiceList serviceList,
+                                     IServiceFactory& serviceFactory,
+                                     StartupTimeline::Pointer timeline,
                                      IPinger::Pointer pinger)
-    : strand_(ioService)
+    : ioService_(ioService)
+    , strand_(ioService)
     , cryptor_(std::move(cryptor))
     , transport_(std::move(transport))
     , messenger_(std::move(messenger))
     , controlServiceChannel_(std::make_shared<aasdk::channel::control::ControlServiceChannel>(strand_, messenger_))
     , configuration_(std::move(configuration))
-    , serviceList_(std::move(serviceList))
+    , serviceFactory_(serviceFactory)
+    , timeline_(std::move(timeline))
     , pinger_(std::move(pinger))
     , eventHandler_(nullptr)
+    , servicesCreated_(false)
+    , serviceDiscoveryPending_(false)
+    , stopped_(false)
 {
 }
 
@@ -59,16 +65,44 @@ void AndroidAutoEntity::start(IAndroidAutoEntityEventHandler& eventHandler)
         OPENAUTO_LOG(info) << "[AndroidAutoEntity] start.";
 
         eventHandler_ = eventHandler;
-        std::for_each(serviceList_.begin(), serviceList_.end(), std::bind(&IService::start, std::placeholders::_1));
         //this->schedulePing();
 
+        // The handshake doesn't need the services, so it goes out first. The
+        // services and their outputs are built meanwhile and only have to be
+        // there once the phone asks for them at service discovery.
         auto versionRequestPromise = aasdk::channel::SendPromise::defer(strand_);
         versionRequestPromise->then([]() {}, std::bind(&AndroidAutoEntity::onChannelError, this->shared_from_this(), std::placeholders::_1));
         controlServiceChannel_->sendVersionRequest(std::move(versionRequestPromise));
         controlServiceChannel_->receive(this->shared_from_this());
+        timeline_->mark("version request sent");
+
+        ioService_.post([this, self = this->shared_from_this()]() {
+            auto serviceList = serviceFactory_.create(messenger_, timeline_);
+            strand_.dispatch(std::bind(&AndroidAutoEntity::onServicesCreated, this->shared_from_this(), std::move(serviceList)));
+        });
     });
 }
 
+void AndroidAutoEntity::onServicesCreated(ServiceList serviceList)
+{
+    if(stopped_)
+    {
+        OPENAUTO_LOG(info) << "[AndroidAutoEntity] services created after stop, dropping them.";
+        return;
+    }
+
+    timeline_->mark("services created");
+    serviceList_ = std::move(serviceList);
+    servicesCreated_ = true;
+    std::for_each(serviceList_.begin(), serviceList_.end(), std::bind(&IService::start, std::placeholders::_1));
+
+    if(serviceDiscoveryPending_)
+    {
+        serviceDiscoveryPending_ = false;
+        this->sendServiceDiscoveryResponse();
+    }
+}
+
 void AndroidAutoEntity::stop()
 {
     strand_.dispatch([this, self = this->shared_from_this()]() {
@@ -76,6 +110,8 @@ void AndroidAutoEntity::stop()
 
         try {
             eventHandler_ = nullptr;
+            stopped_ = true;
+            timeline_->log();
             std::for_each(serviceList_.begin(), serviceList_.end(), std::bind(&IService::stop, std::placeholders::_1));
             //pinger_->cancel();
             messenger_->stop();
@@ -118,6 +154,7 @@ void AndroidAutoEntity::onVersionResponse(uint16_t majorCode, uint16_t minorCode
     OPENAUTO_LOG(info) << "[AndroidAutoEntity] version response, version: " << majorCode
                        << "." << minorCode
                        << ", status: " << status;
+    timeline_->mark("version response");
 
     if(status == aasdk::proto::enums::VersionResponseStatus::MISMATCH)
     {
@@ -163,6 +200,7 @@ void AndroidAutoEntity::onHandshake(const aasdk::common::DataConstBuffer& payloa
         else
         {
             OPENAUTO_LOG(info) << "[AndroidAutoEntity] Auth completed.";
+            timeline_->mark("handshake done");
 
             aasdk::proto::messages::AuthCompleteIndication authCompleteIndication;
             authCompleteIndication.set_status(aasdk::proto::enums::Status::OK);
@@ -184,7 +222,23 @@ void AndroidAutoEntity::onServiceDiscoveryRequest(const aasdk::proto::messages::
 {
     OPENAUTO_LOG(info) << "[AndroidAutoEntity] Discovery request, device name: " << request.device_name()
                        << ", brand: " << request.device_brand();
+    timeline_->mark("service discovery request");
 
+    if(servicesCreated_)
+    {
+        this->sendServiceDiscoveryResponse();
+    }
+    else
+    {
+        OPENAUTO_LOG(info) << "[AndroidAutoEntity] services not created yet, deferring discovery response.";
+        serviceDiscoveryPending_ = true;
+    }
+
+    controlServiceChannel_->receive(this->shared_from_this());
+}
+
+void AndroidAutoEntity::sendServiceDiscoveryResponse()
+{
     aasdk::proto::messages::ServiceDiscoveryResponse serviceDiscoveryResponse;
     serviceDiscoveryResponse.mutable_channels()->Reserve(256);
     serviceDiscoveryResponse.set_head_unit_name("Crankshaft-NG");
@@ -204,19 +258,34 @@ void AndroidAutoEntity::onServiceDiscoveryRequest(const aasdk::proto::messages::
     auto promise = aasdk::channel::SendPromise::defer(strand_);
     promise->then([]() {}, std::bind(&AndroidAutoEntity::onChannelError, this->shared_from_this(), std::placeholders::_1));
     controlServiceChannel_->sendServiceDiscoveryResponse(serviceDiscoveryResponse, std::move(promise));
-    controlServiceChannel_->receive(this->shared_from_this());
+    timeline_->mark("service discovery response");
 }
 
 void AndroidAutoEntity::onAudioFocusRequest(const aasdk::proto::messages::AudioFocusRequest& request)
 {
     OPENAUTO_LOG(info) << "[AndroidAutoEntity] requested audio focus, type: " << request.audio_focus_type();
 
-    aasdk::proto::enums::AudioFocusState::Enum audioFocusState =
-            request.audio_focus_type() == aasdk::proto::enums::AudioFocusType::RELEASE ? aasdk::proto::enums::AudioFocusState::LOSS
-                                                                                       : aasdk::proto::enums::AudioFocusState::GAIN;
+    aasdk::proto::enums::AudioFocusState::Enum audioFocusState;
+
+    switch(request.audio_focus_type())
+    {
+    case aasdk::proto::enums::AudioFocusType::RELEASE:
+        audioFocusState = aasdk::proto::enums::AudioFocusState::LOSS;
+        break;
+
+    case aasdk::proto::enums::AudioFocusType::GAIN_TRANSIENT:
+        audioFocusState = aasdk::proto::enums::AudioFocusState::GAIN_TRANSIENT;
+        break;
+
+    default:
+        audioFocusState = aasdk::proto::enums::AudioFocusState::GAIN;
+        break;
+    }
 
     OPENAUTO_LOG(info) << "[AndroidAutoEntity] audio focus state: " << audioFocusState;
 
+    std::for_each(serviceList_.begin(), serviceList_.end(), std::bind(&IService::onAudioFocusChanged, std::placeholders::_1, request.audio_focus_type()));
+
     aasdk::proto::messages::AudioFocusResponse response;
     response.set_audio_focus_state(audioFocusState);
 
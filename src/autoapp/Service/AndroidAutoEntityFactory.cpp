@@ -26,7 +26,9 @@
 #include <aasdk/Messenger/Messenger.hpp>
 #include <f1x/openauto/autoapp/Service/AndroidAutoEntityFactory.hpp>
 #include <f1x/openauto/autoapp/Service/AndroidAutoEntity.hpp>
+#include <f1x/openauto/autoapp/Service/CachingSSLWrapper.hpp>
 #include <f1x/openauto/autoapp/Service/Pinger.hpp>
+#include <f1x/openauto/autoapp/Service/RecordingMessenger.hpp>
 
 namespace f1x
 {
@@ -43,6 +45,7 @@ AndroidAutoEntityFactory::AndroidAutoEntityFactory(boost::asio::io_service& ioSe
     : ioService_(ioService)
     , configuration_(std::move(configuration))
     , serviceFactory_(serviceFactory)
+    , sslWrapper_(std::make_shared<CachingSSLWrapper>(std::make_shared<aasdk::transport::SSLWrapper>()))
 {
 
 }
@@ -61,17 +64,25 @@ IAndroidAutoEntity::Pointer AndroidAutoEntityFactory::create(aasdk::tcp::ITCPEnd
 
 IAndroidAutoEntity::Pointer AndroidAutoEntityFactory::create(aasdk::transport::ITransport::Pointer transport)
 {
-    auto sslWrapper(std::make_shared<aasdk::transport::SSLWrapper>());
-    auto cryptor(std::make_shared<aasdk::messenger::Cryptor>(std::move(sslWrapper)));
+    auto timeline(std::make_shared<StartupTimeline>());
+    auto cryptor(std::make_shared<aasdk::messenger::Cryptor>(sslWrapper_));
     cryptor->init();
 
-    auto messenger(std::make_shared<aasdk::messenger::Messenger>(ioService_,
+    aasdk::messenger::IMessenger::Pointer messenger(std::make_shared<aasdk::messenger::Messenger>(ioService_,
                                                                  std::make_shared<aasdk::messenger::MessageInStream>(ioService_, transport, cryptor),
                                                                  std::make_shared<aasdk::messenger::MessageOutStream>(ioService_, transport, cryptor)));
 
-    auto serviceList = serviceFactory_.create(messenger);
+    // Each connection overwrites the capture of the previous one.
+    const auto capturePath = configuration_->getSessionCapturePath();
+    auto sessionLog = std::make_shared<SessionLogWriter>();
+    if(!capturePath.empty() && sessionLog->open(capturePath))
+    {
+        messenger = std::make_shared<RecordingMessenger>(ioService_, std::move(messenger), std::move(sessionLog));
+    }
+
+    // The services are created by the entity itself, alongside the handshake.
     auto pinger(std::make_shared<Pinger>(ioService_, 5000));
-    return std::make_shared<AndroidAutoEntity>(ioService_, std::move(cryptor), std::move(transport), std::move(messenger), configuration_, std::move(serviceList), std::move(pinger));
+    return std::make_shared<AndroidAutoEntity>(ioService_, std::move(cryptor), std::move(transport), std::move(messenger), configuration_, serviceFactory_, std::move(timeline), std::move(pinger));
 }
 
 }
@@ -29,10 +29,13 @@ namespace autoapp
 namespace service
 {
 
-AudioInputService::AudioInputService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioInput::Pointer audioInput)
+AudioInputService::AudioInputService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioInput::Pointer audioInput,
+                                     projection::AudioInputProcessor::Pointer processor)
     : strand_(ioService)
     , channel_(std::make_shared<aasdk::channel::av::AVInputServiceChannel>(strand_, std::move(messenger)))
     , audioInput_(std::move(audioInput))
+    , processor_(std::move(processor))
+    , processingStrand_(ioService)
     , session_(0)
 {
 
@@ -68,6 +71,10 @@ void AudioInputService::resume()
     });
 }
 
+void AudioInputService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum)
+{
+}
+
 void AudioInputService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response)
 {
     OPENAUTO_LOG(info) << "[AudioInputService] fill features.";
@@ -84,6 +91,11 @@ void AudioInputService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryRes
     audioConfig->set_channel_count(audioInput_->getChannelCount());
 }
 
+aasdk::messenger::ChannelId AudioInputService::getChannelId() const
+{
+    return channel_->getId();
+}
+
 void AudioInputService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
     OPENAUTO_LOG(info) << "[AudioInputService] open request, priority: " << request.priority();
@@ -128,6 +140,13 @@ void AudioInputService::onAVInputOpenRequest(const aasdk::proto::messages::AVInp
 
     if(request.open())
     {
+        if(processor_ != nullptr)
+        {
+            processingStrand_.post([processor = processor_, echoCancellation = request.ec(), noiseSuppression = request.anc()]() {
+                processor->configure(echoCancellation, noiseSuppression);
+            });
+        }
+
         auto startPromise = projection::IAudioInput::StartPromise::defer(strand_);
         startPromise->then(std::bind(&AudioInputService::onAudioInputOpenSucceed, this->shared_from_this()),
             [this, self = this->shared_from_this()]() {
@@ -148,6 +167,13 @@ void AudioInputService::onAVInputOpenRequest(const aasdk::proto::messages::AVInp
     {
         audioInput_->stop();
 
+        if(processor_ != nullptr)
+        {
+            OPENAUTO_LOG(info) << "[AudioInputService] processing stats"
+                               << ", frames over budget: " << processor_->getBudgetOverruns()
+                               << ", max load: " << processor_->getMaxLoad() << "%";
+        }
+
         aasdk::proto::messages::AVInputOpenResponse response;
         response.set_session(session_);
         response.set_value(0);
@@ -186,13 +212,36 @@ void AudioInputService::onAudioInputOpenSucceed()
 }
 
 void AudioInputService::onAudioInputDataReady(aasdk::common::Data data)
+{
+    if(processor_ == nullptr)
+    {
+        this->sendAudioInput(std::move(data));
+        return;
+    }
+
+    processingStrand_.post([this, self = this->shared_from_this(), data = std::move(data)]() mutable {
+        if(processor_->isEnabled())
+        {
+            processor_->process(data);
+        }
+
+        strand_.dispatch([this, self, data = std::move(data)]() mutable {
+            this->sendAudioInput(std::move(data));
+        });
+    });
+}
+
+void AudioInputService::sendAudioInput(aasdk::common::Data data)
 {
     auto sendPromise = aasdk::channel::SendPromise::defer(strand_);
     sendPromise->then(std::bind(&AudioInputService::readAudioInput, this->shared_from_this()),
                      std::bind(&AudioInputService::onChannelError, this->shared_from_this(), std::placeholders::_1));
 
     auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch());
-    channel_->sendAVMediaWithTimestampIndication(timestamp.count(), std::move(data), std::move(sendPromise));
+    // The channel copies the payload into the outgoing message, so the
+    // buffer can go straight back to the input.
+    channel_->sendAVMediaWithTimestampIndication(timestamp.count(), data, std::move(sendPromise));
+    audioInput_->release(std::move(data));
 }
 
 void AudioInputService::readAudioInput()
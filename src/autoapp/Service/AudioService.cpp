@@ -16,6 +16,7 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <f1x/openauto/Common/Log.hpp>
 #include <f1x/openauto/autoapp/Service/AudioService.hpp>
 
@@ -28,11 +29,23 @@ namespace autoapp
 namespace service
 {
 
-AudioService::AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput)
+// Sample rates the phone is known to stream at.
+static constexpr uint32_t cStreamSampleRates[] = {8000, 16000, 44100, 48000};
+// How long a partial window may wait to be acknowledged, and how often a
+// full output is polled for room, in milliseconds.
+static constexpr uint32_t cAckInterval = 10;
+
+AudioService::AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked)
     : strand_(ioService)
+    , ackTimer_(ioService)
     , channel_(std::move(channel))
     , audioOutput_(std::move(audioOutput))
     , session_(-1)
+    , maxUnacked_(std::max<uint32_t>(maxUnacked, 1))
+    , unackedPackets_(0)
+    , ackScheduled_(false)
+    , outputOpen_(false)
+    , outputSuspended_(false)
 {
 
 }
@@ -49,7 +62,9 @@ void AudioService::stop()
 {
     strand_.dispatch([this, self = this->shared_from_this()]() {
         OPENAUTO_LOG(info) << "[AudioService] stop, channel: " << aasdk::messenger::channelIdToString(channel_->getId());
+        ackTimer_.cancel();
         audioOutput_->stop();
+        outputOpen_ = false;
     });
 }
 
@@ -67,6 +82,10 @@ void AudioService::resume()
     });
 }
 
+void AudioService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum)
+{
+}
+
 void AudioService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response)
 {
     OPENAUTO_LOG(info) << "[AudioService] fill features, channel: " << aasdk::messenger::channelIdToString(channel_->getId());
@@ -96,10 +115,40 @@ void AudioService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse
 
     audioChannel->set_available_while_in_call(true);
 
-    auto* audioConfig = audioChannel->add_audio_configs();
-    audioConfig->set_sample_rate(audioOutput_->getSampleRate());
-    audioConfig->set_bit_depth(audioOutput_->getSampleSize());
-    audioConfig->set_channel_count(audioOutput_->getChannelCount());
+    // Offer whatever the device plays natively, in its order of preference,
+    // so that no resampler has to run on every sample. The channel layout
+    // stays as configured; the current format is the fallback.
+    const auto currentFormat = this->getCurrentFormat();
+    audioFormats_.clear();
+
+    for(const auto& format : audioOutput_->getSupportedFormats())
+    {
+        const bool streamable = std::find(std::begin(cStreamSampleRates), std::end(cStreamSampleRates), format.sampleRate) != std::end(cStreamSampleRates);
+
+        if(streamable && format.sampleSize == currentFormat.sampleSize && format.channelCount == currentFormat.channelCount
+                && std::find(audioFormats_.begin(), audioFormats_.end(), format) == audioFormats_.end())
+        {
+            audioFormats_.push_back(format);
+        }
+    }
+
+    if(std::find(audioFormats_.begin(), audioFormats_.end(), currentFormat) == audioFormats_.end())
+    {
+        audioFormats_.push_back(currentFormat);
+    }
+
+    for(const auto& format : audioFormats_)
+    {
+        auto* audioConfig = audioChannel->add_audio_configs();
+        audioConfig->set_sample_rate(format.sampleRate);
+        audioConfig->set_bit_depth(format.sampleSize);
+        audioConfig->set_channel_count(format.channelCount);
+    }
+}
+
+aasdk::messenger::ChannelId AudioService::getChannelId() const
+{
+    return channel_->getId();
 }
 
 void AudioService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
@@ -113,9 +162,11 @@ void AudioService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpe
                         << ", sample size: " << audioOutput_->getSampleSize()
                         << ", channel count: " << audioOutput_->getChannelCount();
 
-    const aasdk::proto::enums::Status::Enum status = audioOutput_->open() ? aasdk::proto::enums::Status::OK : aasdk::proto::enums::Status::FAIL;
+    outputOpen_ = outputSuspended_ || audioOutput_->open();
+    const aasdk::proto::enums::Status::Enum status = outputOpen_ ? aasdk::proto::enums::Status::OK : aasdk::proto::enums::Status::FAIL;
     OPENAUTO_LOG(info) << "[AudioService] open status: " << status
-                       << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId());
+                       << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
+                       << ", output latency: " << audioOutput_->getBufferStats().outputLatency << "ms";
 
     aasdk::proto::messages::ChannelOpenResponse response;
     response.set_status(status);
@@ -131,14 +182,29 @@ void AudioService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChann
     OPENAUTO_LOG(info) << "[AudioService] setup request"
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
                        << ", config index: " << request.config_index();
-    const aasdk::proto::enums::AVChannelSetupStatus::Enum status = aasdk::proto::enums::AVChannelSetupStatus::OK;
+
+    auto status = aasdk::proto::enums::AVChannelSetupStatus::OK;
+    uint32_t configIndex = request.config_index();
+
+    if(configIndex >= audioFormats_.size())
+    {
+        OPENAUTO_LOG(warning) << "[AudioService] unknown config index, keeping the current format"
+                              << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId());
+        const auto currentFormat = std::find(audioFormats_.begin(), audioFormats_.end(), this->getCurrentFormat());
+        configIndex = currentFormat == audioFormats_.end() ? 0 : std::distance(audioFormats_.begin(), currentFormat);
+    }
+    else if(!this->selectFormat(audioFormats_[configIndex]))
+    {
+        status = aasdk::proto::enums::AVChannelSetupStatus::FAIL;
+    }
+
     OPENAUTO_LOG(info) << "[AudioService] setup status: " << status
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId());
 
     aasdk::proto::messages::AVChannelSetupResponse response;
     response.set_media_status(status);
-    response.set_max_unacked(1);
-    response.add_configs(0);
+    response.set_max_unacked(maxUnacked_);
+    response.add_configs(configIndex);
 
     auto promise = aasdk::channel::SendPromise::defer(strand_);
     promise->then([]() {}, std::bind(&AudioService::onChannelError, this->shared_from_this(), std::placeholders::_1));
@@ -152,7 +218,13 @@ void AudioService::onAVChannelStartIndication(const aasdk::proto::messages::AVCh
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
                        << ", session: " << indication.session();
     session_ = indication.session();
-    audioOutput_->start();
+    unackedPackets_ = 0;
+
+    if(!outputSuspended_)
+    {
+        audioOutput_->start();
+    }
+
     channel_->receive(this->shared_from_this());
 }
 
@@ -161,21 +233,50 @@ void AudioService::onAVChannelStopIndication(const aasdk::proto::messages::AVCha
     OPENAUTO_LOG(info) << "[AudioService] stop indication"
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
                        << ", session: " << session_;
+
+    const auto stats = audioOutput_->getBufferStats();
+    OPENAUTO_LOG(info) << "[AudioService] buffer stats"
+                       << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
+                       << ", underruns: " << stats.underruns
+                       << ", overruns: " << stats.overruns
+                       << ", depth: " << stats.depth << "ms"
+                       << ", target latency: " << stats.targetLatency << "ms"
+                       << ", output latency: " << stats.outputLatency << "ms"
+                       << ", callback overruns: " << stats.callbackOverruns
+                       << ", max callback load: " << stats.maxCallbackLoad << "%";
+
     session_ = -1;
-    audioOutput_->suspend();
+    unackedPackets_ = 0;
+
+    if(!outputSuspended_)
+    {
+        audioOutput_->suspend();
+    }
+
     channel_->receive(this->shared_from_this());
 }
 
 void AudioService::onAVMediaWithTimestampIndication(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    audioOutput_->write(timestamp, buffer);
-    aasdk::proto::messages::AVMediaAckIndication indication;
-    indication.set_session(session_);
-    indication.set_value(1);
+    if(!outputSuspended_)
+    {
+        audioOutput_->write(timestamp, buffer);
+    }
+
+    ++unackedPackets_;
+
+    // With a window, acks go out for half of it at a time while the output
+    // has room, so the phone can stream ahead without waiting on a round
+    // trip per packet. A full output holds them back and throttles it.
+    if(maxUnacked_ <= 1 || (unackedPackets_ >= std::max<uint32_t>(maxUnacked_ / 2, 1) && !this->isOutputFull()))
+    {
+        this->sendAVMediaAckIndication();
+    }
+    else
+    {
+        this->scheduleAck();
+    }
 
-    auto promise = aasdk::channel::SendPromise::defer(strand_);
-    promise->then([]() {}, std::bind(&AudioService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-    channel_->sendAVMediaAckIndication(indication, std::move(promise));
     channel_->receive(this->shared_from_this());
 }
 
@@ -184,6 +285,139 @@ void AudioService::onAVMediaIndication(const aasdk::common::DataConstBuffer& buf
     this->onAVMediaWithTimestampIndication(0, buffer);
 }
 
+void AudioService::suspendOutput()
+{
+    if(outputSuspended_)
+    {
+        return;
+    }
+
+    OPENAUTO_LOG(info) << "[AudioService] suspend output, channel: " << aasdk::messenger::channelIdToString(channel_->getId());
+    outputSuspended_ = true;
+
+    // Releasing rather than pausing gives the device and the queued audio
+    // back, pooled outputs included; the stream would be stale by the time
+    // focus returns anyway.
+    if(outputOpen_)
+    {
+        audioOutput_->release();
+    }
+}
+
+void AudioService::resumeOutput()
+{
+    if(!outputSuspended_)
+    {
+        return;
+    }
+
+    OPENAUTO_LOG(info) << "[AudioService] resume output, channel: " << aasdk::messenger::channelIdToString(channel_->getId());
+    outputSuspended_ = false;
+
+    if(outputOpen_)
+    {
+        outputOpen_ = audioOutput_->open();
+
+        if(outputOpen_ && session_ != -1)
+        {
+            audioOutput_->start();
+        }
+    }
+}
+
+projection::AudioFormat AudioService::getCurrentFormat() const
+{
+    projection::AudioFormat format;
+    format.sampleRate = audioOutput_->getSampleRate();
+    format.sampleSize = audioOutput_->getSampleSize();
+    format.channelCount = audioOutput_->getChannelCount();
+    return format;
+}
+
+bool AudioService::selectFormat(const projection::AudioFormat& format)
+{
+    if(format == this->getCurrentFormat())
+    {
+        return true;
+    }
+
+    OPENAUTO_LOG(info) << "[AudioService] switching format"
+                       << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
+                       << ", sample rate: " << format.sampleRate
+                       << ", sample size: " << format.sampleSize
+                       << ", channel count: " << format.channelCount;
+
+    // The device has already been opened with the old format.
+    const bool reopen = outputOpen_ && !outputSuspended_;
+
+    if(reopen)
+    {
+        audioOutput_->stop();
+    }
+
+    const bool formatSet = audioOutput_->setFormat(format);
+
+    if(reopen)
+    {
+        outputOpen_ = audioOutput_->open();
+    }
+
+    return formatSet && (outputOpen_ || !reopen);
+}
+
+bool AudioService::isOutputFull() const
+{
+    if(outputSuspended_)
+    {
+        return false;
+    }
+
+    // Beyond twice the target the jitter buffer starts dropping audio.
+    const auto stats = audioOutput_->getBufferStats();
+    return stats.targetLatency > 0 && stats.depth >= stats.targetLatency * 2;
+}
+
+void AudioService::scheduleAck()
+{
+    if(!ackScheduled_)
+    {
+        ackScheduled_ = true;
+        ackTimer_.expires_from_now(boost::posix_time::milliseconds(cAckInterval));
+        ackTimer_.async_wait(strand_.wrap(std::bind(&AudioService::onAckTimerExpired, this->shared_from_this(), std::placeholders::_1)));
+    }
+}
+
+void AudioService::onAckTimerExpired(const boost::system::error_code& e)
+{
+    ackScheduled_ = false;
+
+    if(e || unackedPackets_ == 0)
+    {
+        return;
+    }
+
+    if(this->isOutputFull())
+    {
+        this->scheduleAck();
+    }
+    else
+    {
+        this->sendAVMediaAckIndication();
+    }
+}
+
+void AudioService::sendAVMediaAckIndication()
+{
+    aasdk::proto::messages::AVMediaAckIndication indication;
+    indication.set_session(session_);
+    indication.set_value(unackedPackets_);
+    unackedPackets_ = 0;
+
+    auto promise = aasdk::channel::SendPromise::defer(strand_);
+    promise->then([]() {}, std::bind(&AudioService::onChannelError, this->shared_from_this(), std::placeholders::_1));
+    channel_->sendAVMediaAckIndication(indication, std::move(promise));
+}
+
 void AudioService::onChannelError(const aasdk::error::Error& e)
 {
     OPENAUTO_LOG(error) << "[AudioService] channel error: " << e.what()
@@ -66,6 +66,10 @@ void BluetoothService::resume()
     });
 }
 
+void BluetoothService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum)
+{
+}
+
 void BluetoothService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response)
 {
     OPENAUTO_LOG(info) << "[BluetoothService] fill features";
@@ -83,6 +87,11 @@ void BluetoothService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResp
     }
 }
 
+aasdk::messenger::ChannelId BluetoothService::getChannelId() const
+{
+    return channel_->getId();
+}
+
 void BluetoothService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
     OPENAUTO_LOG(info) << "[BluetoothService] open request, priority: " << request.priority();
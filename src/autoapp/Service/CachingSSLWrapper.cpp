@@ -0,0 +1,344 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <time.h>
+#include <f1x/openauto/autoapp/Service/CachingSSLWrapper.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+CachingSSLWrapper::CachingSSLWrapper(aasdk::transport::ISSLWrapper::Pointer sslWrapper)
+    : sslWrapper_(std::move(sslWrapper))
+    , certificate_(nullptr)
+    , privateKey_(nullptr)
+    , method_(nullptr)
+    , context_(nullptr)
+    , certificateUsed_(false)
+    , privateKeyUsed_(false)
+    , session_(nullptr)
+    , fullHandshakes_(0)
+    , resumedHandshakes_(0)
+{
+
+}
+
+CachingSSLWrapper::~CachingSSLWrapper()
+{
+    if(session_ != nullptr)
+    {
+        SSL_SESSION_free(session_);
+    }
+
+    if(context_ != nullptr)
+    {
+        sslWrapper_->free(context_);
+    }
+
+    if(certificate_ != nullptr)
+    {
+        sslWrapper_->free(certificate_);
+    }
+
+    if(privateKey_ != nullptr)
+    {
+        sslWrapper_->free(privateKey_);
+    }
+}
+
+X509* CachingSSLWrapper::readCertificate(const std::string& certificate)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(certificate_ == nullptr)
+    {
+        certificate_ = sslWrapper_->readCertificate(certificate);
+        certificatePem_ = certificate;
+        return certificate_;
+    }
+
+    return certificate == certificatePem_ ? certificate_ : sslWrapper_->readCertificate(certificate);
+}
+
+EVP_PKEY* CachingSSLWrapper::readPrivateKey(const std::string& privateKey)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(privateKey_ == nullptr)
+    {
+        privateKey_ = sslWrapper_->readPrivateKey(privateKey);
+        privateKeyPem_ = privateKey;
+        return privateKey_;
+    }
+
+    return privateKey == privateKeyPem_ ? privateKey_ : sslWrapper_->readPrivateKey(privateKey);
+}
+
+const SSL_METHOD* CachingSSLWrapper::getMethod()
+{
+    return sslWrapper_->getMethod();
+}
+
+SSL_CTX* CachingSSLWrapper::createContext(const SSL_METHOD* method)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(context_ == nullptr)
+    {
+        context_ = sslWrapper_->createContext(method);
+        method_ = method;
+        return context_;
+    }
+
+    return method == method_ ? context_ : sslWrapper_->createContext(method);
+}
+
+bool CachingSSLWrapper::useCertificate(SSL_CTX* context, X509* certificate)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(context != context_ || certificate != certificate_)
+    {
+        return sslWrapper_->useCertificate(context, certificate);
+    }
+
+    if(!certificateUsed_)
+    {
+        certificateUsed_ = sslWrapper_->useCertificate(context, certificate);
+    }
+
+    return certificateUsed_;
+}
+
+bool CachingSSLWrapper::usePrivateKey(SSL_CTX* context, EVP_PKEY* privateKey)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(context != context_ || privateKey != privateKey_)
+    {
+        return sslWrapper_->usePrivateKey(context, privateKey);
+    }
+
+    if(!privateKeyUsed_)
+    {
+        privateKeyUsed_ = sslWrapper_->usePrivateKey(context, privateKey);
+    }
+
+    return privateKeyUsed_;
+}
+
+SSL* CachingSSLWrapper::createInstance(SSL_CTX* context)
+{
+    auto ssl = sslWrapper_->createInstance(context);
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(ssl != nullptr && context == context_)
+    {
+        // Must be set before the handshake starts; the phone decides whether
+        // it is resumed.
+        const bool sessionOffered = session_ != nullptr && SSL_set_session(ssl, session_) == 1;
+        handshakes_[ssl] = Handshake{std::chrono::steady_clock::now(), std::chrono::nanoseconds(0), sessionOffered};
+    }
+
+    return ssl;
+}
+
+bool CachingSSLWrapper::checkPrivateKey(SSL* ssl)
+{
+    return sslWrapper_->checkPrivateKey(ssl);
+}
+
+aasdk::transport::ISSLWrapper::BIOs CachingSSLWrapper::createBIOs()
+{
+    return sslWrapper_->createBIOs();
+}
+
+void CachingSSLWrapper::setBIOs(SSL* ssl, const BIOs& bIOs, size_t maxBufferSize)
+{
+    sslWrapper_->setBIOs(ssl, bIOs, maxBufferSize);
+}
+
+void CachingSSLWrapper::setConnectState(SSL* ssl)
+{
+    sslWrapper_->setConnectState(ssl);
+}
+
+int CachingSSLWrapper::doHandshake(SSL* ssl)
+{
+    const auto cpuTimeBefore = threadCpuTime();
+    const auto result = sslWrapper_->doHandshake(ssl);
+    const auto cpuTime = threadCpuTime() - cpuTimeBefore;
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    auto handshake = handshakes_.find(ssl);
+    if(handshake == handshakes_.end())
+    {
+        return result;
+    }
+
+    handshake->second.cpuTime += cpuTime;
+
+    if(result == 1)
+    {
+        const bool resumed = SSL_session_reused(ssl) != 0;
+        if(resumed)
+        {
+            ++resumedHandshakes_;
+        }
+        else
+        {
+            ++fullHandshakes_;
+        }
+
+        if(session_ != nullptr)
+        {
+            SSL_SESSION_free(session_);
+        }
+        session_ = SSL_get1_session(ssl);
+
+        OPENAUTO_LOG(info) << "[CachingSSLWrapper] " << (resumed ? "resumed" : "full") << " handshake in "
+                           << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - handshake->second.start).count() << "ms"
+                           << ", cpu: " << std::chrono::duration_cast<std::chrono::milliseconds>(handshake->second.cpuTime).count() << "ms"
+                           << ", resumed so far: " << resumedHandshakes_ << "/" << resumedHandshakes_ + fullHandshakes_;
+
+        handshakes_.erase(handshake);
+        return result;
+    }
+
+    const auto error = SSL_get_error(ssl, result);
+    if(error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE)
+    {
+        // Some phones fail the handshake instead of falling back to a full
+        // one, so the next connection starts over.
+        if(handshake->second.sessionOffered && session_ != nullptr)
+        {
+            OPENAUTO_LOG(warning) << "[CachingSSLWrapper] handshake failed with a cached session, dropping it.";
+            SSL_SESSION_free(session_);
+            session_ = nullptr;
+        }
+
+        handshakes_.erase(handshake);
+    }
+
+    return result;
+}
+
+int CachingSSLWrapper::getError(SSL* ssl, int returnCode)
+{
+    return sslWrapper_->getError(ssl, returnCode);
+}
+
+void CachingSSLWrapper::free(SSL* ssl)
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        handshakes_.erase(ssl);
+    }
+
+    // Connections end by dropping the transport, never with close_notify,
+    // and OpenSSL marks the session of such a connection not resumable when
+    // it is freed. TLS 1.2 no longer requires that, so it is marked as shut
+    // down cleanly instead; fatal alerts still invalidate it.
+    if(ssl != nullptr && SSL_is_init_finished(ssl))
+    {
+        SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+
+    sslWrapper_->free(ssl);
+}
+
+void CachingSSLWrapper::free(SSL_CTX* context)
+{
+    if(context != context_)
+    {
+        sslWrapper_->free(context);
+    }
+}
+
+void CachingSSLWrapper::free(BIO* bio)
+{
+    sslWrapper_->free(bio);
+}
+
+void CachingSSLWrapper::free(X509* certificate)
+{
+    if(certificate != certificate_)
+    {
+        sslWrapper_->free(certificate);
+    }
+}
+
+void CachingSSLWrapper::free(EVP_PKEY* privateKey)
+{
+    if(privateKey != privateKey_)
+    {
+        sslWrapper_->free(privateKey);
+    }
+}
+
+size_t CachingSSLWrapper::bioCtrlPending(BIO* b)
+{
+    return sslWrapper_->bioCtrlPending(b);
+}
+
+int CachingSSLWrapper::bioRead(BIO *b, void *data, int len)
+{
+    return sslWrapper_->bioRead(b, data, len);
+}
+
+int CachingSSLWrapper::bioWrite(BIO *b, const void *data, int len)
+{
+    return sslWrapper_->bioWrite(b, data, len);
+}
+
+int CachingSSLWrapper::getAvailableBytes(const SSL* ssl)
+{
+    return sslWrapper_->getAvailableBytes(ssl);
+}
+
+int CachingSSLWrapper::sslRead(SSL *ssl, void *buf, int num)
+{
+    return sslWrapper_->sslRead(ssl, buf, num);
+}
+
+int CachingSSLWrapper::sslWrite(SSL *ssl, const void *buf, int num)
+{
+    return sslWrapper_->sslWrite(ssl, buf, num);
+}
+
+// The handshake runs on whichever io_service thread delivered the message,
+// so wall time alone would include waiting for the phone.
+std::chrono::nanoseconds CachingSSLWrapper::threadCpuTime()
+{
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+}
+}
+}
+}
@@ -67,6 +67,10 @@ void InputService::resume()
     });
 }
 
+void InputService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum)
+{
+}
+
 void InputService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response)
 {
     OPENAUTO_LOG(info) << "[InputService] fill features.";
@@ -93,6 +97,11 @@ void InputService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse
     }
 }
 
+aasdk::messenger::ChannelId InputService::getChannelId() const
+{
+    return channel_->getId();
+}
+
 void InputService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
     OPENAUTO_LOG(info) << "[InputService] open request, priority: " << request.priority();
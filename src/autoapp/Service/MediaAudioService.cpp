@@ -17,6 +17,7 @@
 */
 
 #include <aasdk/Channel/AV/MediaAudioServiceChannel.hpp>
+#include <f1x/openauto/Common/Log.hpp>
 #include <f1x/openauto/autoapp/Service/MediaAudioService.hpp>
 
 namespace f1x
@@ -28,12 +29,43 @@ namespace autoapp
 namespace service
 {
 
-MediaAudioService::MediaAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput)
-    : AudioService(ioService, std::make_shared<aasdk::channel::av::MediaAudioServiceChannel>(strand_, std::move(messenger)), std::move(audioOutput))
+MediaAudioService::MediaAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked, float duckLevel)
+    : AudioService(ioService, std::make_shared<aasdk::channel::av::MediaAudioServiceChannel>(strand_, std::move(messenger)), std::move(audioOutput), maxUnacked)
+    , duckLevel_(duckLevel)
 {
 
 }
 
+void MediaAudioService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum focusType)
+{
+    strand_.dispatch([this, self = this->shared_from_this(), focusType]() {
+        OPENAUTO_LOG(info) << "[MediaAudioService] audio focus changed, type: " << focusType;
+
+        // The protocol has no exclusive focus type, and the phone asks for
+        // GAIN whenever media itself starts, so the transient types are
+        // split instead: GAIN_NAVI ducks and GAIN_TRANSIENT stands in for
+        // exclusive focus.
+        switch(focusType)
+        {
+        case aasdk::proto::enums::AudioFocusType::GAIN_NAVI:
+            // Guidance is played on the speech channel on top of the media.
+            this->resumeOutput();
+            audioOutput_->setGain(duckLevel_);
+            break;
+
+        case aasdk::proto::enums::AudioFocusType::GAIN_TRANSIENT:
+            // Assistant or call audio; nobody listens to the media meanwhile.
+            this->suspendOutput();
+            break;
+
+        default:
+            this->resumeOutput();
+            audioOutput_->setGain(1.0f);
+            break;
+        }
+    });
+}
+
 }
 }
 }
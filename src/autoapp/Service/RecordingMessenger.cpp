@@ -0,0 +1,67 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Service/RecordingMessenger.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+RecordingMessenger::RecordingMessenger(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, SessionLogWriter::Pointer log)
+    : ioService_(ioService)
+    , messenger_(std::move(messenger))
+    , log_(std::move(log))
+{
+
+}
+
+void RecordingMessenger::enqueueReceive(aasdk::messenger::ChannelId channelId, aasdk::messenger::ReceivePromise::Pointer promise)
+{
+    auto interceptor = aasdk::messenger::ReceivePromise::defer(ioService_);
+    interceptor->then([log = log_, promise](aasdk::messenger::Message::Pointer message) {
+        log->write(SessionLogDirection::IN, *message);
+        promise->resolve(std::move(message));
+    },
+    [promise](const aasdk::error::Error& e) {
+        promise->reject(e);
+    });
+
+    messenger_->enqueueReceive(channelId, std::move(interceptor));
+}
+
+void RecordingMessenger::enqueueSend(aasdk::messenger::Message::Pointer message, aasdk::messenger::SendPromise::Pointer promise)
+{
+    log_->write(SessionLogDirection::OUT, *message);
+    messenger_->enqueueSend(std::move(message), std::move(promise));
+}
+
+void RecordingMessenger::stop()
+{
+    messenger_->stop();
+}
+
+}
+}
+}
+}
@@ -0,0 +1,247 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Service/ReplayMessenger.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+ReplayMessenger::ReplayMessenger(boost::asio::io_service& ioService, SessionLogReader::Pointer log, double speed)
+    : strand_(ioService)
+    , timer_(ioService)
+    , log_(std::move(log))
+    , speed_(std::max(speed, 0.0))
+    , hasNext_(false)
+    , exhausted_(false)
+    , started_(false)
+{
+
+}
+
+void ReplayMessenger::start(ChannelIds channelIds, Promise::Pointer promise)
+{
+    strand_.dispatch([this, self = this->shared_from_this(), channelIds = std::move(channelIds), promise = std::move(promise)]() mutable {
+        channelIds_ = std::move(channelIds);
+        promise_ = std::move(promise);
+        this->startIfListening();
+    });
+}
+
+void ReplayMessenger::enqueueReceive(aasdk::messenger::ChannelId channelId, aasdk::messenger::ReceivePromise::Pointer promise)
+{
+    strand_.dispatch([this, self = this->shared_from_this(), channelId, promise = std::move(promise)]() mutable {
+        receivePromises_[channelId].push_back(std::move(promise));
+
+        if(!started_)
+        {
+            this->startIfListening();
+            return;
+        }
+
+        this->deliver(channelId);
+
+        // Replaying as fast as possible waits for the channel to catch up.
+        if(speed_ == 0 && hasNext_ && next_.channelId == channelId)
+        {
+            this->scheduleNext();
+        }
+    });
+}
+
+void ReplayMessenger::enqueueSend(aasdk::messenger::Message::Pointer message, aasdk::messenger::SendPromise::Pointer promise)
+{
+    strand_.dispatch([this, self = this->shared_from_this(), message = std::move(message), promise = std::move(promise)]() {
+        ++statistics_[message->getChannelId()].sent;
+        promise->resolve();
+    });
+}
+
+void ReplayMessenger::stop()
+{
+    strand_.dispatch([this, self = this->shared_from_this()]() {
+        timer_.cancel();
+        hasNext_ = false;
+        exhausted_ = true;
+
+        for(auto& channelPromises : receivePromises_)
+        {
+            for(auto& promise : channelPromises.second)
+            {
+                promise->reject(aasdk::error::Error(aasdk::error::ErrorCode::OPERATION_ABORTED));
+            }
+
+            channelPromises.second.clear();
+        }
+
+        if(promise_ != nullptr)
+        {
+            promise_->reject(aasdk::error::Error(aasdk::error::ErrorCode::OPERATION_ABORTED));
+            promise_.reset();
+        }
+    });
+}
+
+ReplayMessenger::Statistics ReplayMessenger::getStatistics() const
+{
+    return statistics_;
+}
+
+void ReplayMessenger::startIfListening()
+{
+    if(started_ || promise_ == nullptr)
+    {
+        return;
+    }
+
+    for(const auto& channelId : channelIds_)
+    {
+        if(receivePromises_.count(channelId) == 0)
+        {
+            return;
+        }
+    }
+
+    started_ = true;
+    start_ = std::chrono::steady_clock::now();
+    this->scheduleNext();
+}
+
+bool ReplayMessenger::readNext()
+{
+    while(log_->read(next_))
+    {
+        if(next_.direction == SessionLogDirection::IN && next_.channelId != aasdk::messenger::ChannelId::CONTROL)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ReplayMessenger::scheduleNext()
+{
+    while(!exhausted_)
+    {
+        if(!hasNext_ && !(hasNext_ = this->readNext()))
+        {
+            exhausted_ = true;
+            this->checkFinished();
+            return;
+        }
+
+        if(speed_ > 0)
+        {
+            const auto due = start_ + std::chrono::microseconds(static_cast<uint64_t>(next_.time / speed_));
+            const auto now = std::chrono::steady_clock::now();
+
+            if(due > now)
+            {
+                timer_.expires_from_now(boost::posix_time::microseconds(std::chrono::duration_cast<std::chrono::microseconds>(due - now).count()));
+                timer_.async_wait(strand_.wrap(std::bind(&ReplayMessenger::onTimerExpired, this->shared_from_this(), std::placeholders::_1)));
+                return;
+            }
+        }
+        else if(!messages_[next_.channelId].empty())
+        {
+            return;
+        }
+
+        hasNext_ = false;
+        this->queue(next_);
+    }
+}
+
+void ReplayMessenger::onTimerExpired(const boost::system::error_code& error)
+{
+    if(error != boost::asio::error::operation_aborted)
+    {
+        this->scheduleNext();
+    }
+}
+
+void ReplayMessenger::queue(const SessionRecord& record)
+{
+    auto& statistics = statistics_[record.channelId];
+
+    // Has no service behind it in this configuration.
+    if(channelIds_.count(record.channelId) == 0)
+    {
+        ++statistics.dropped;
+        return;
+    }
+
+    auto message = std::make_shared<aasdk::messenger::Message>(record.channelId, record.encryptionType, record.messageType);
+    message->insertPayload(record.payload);
+
+    auto& messages = messages_[record.channelId];
+    messages.push_back(std::move(message));
+
+    ++statistics.received;
+    statistics.receivedBytes += record.payload.size();
+    statistics.maxBacklog = std::max(statistics.maxBacklog, messages.size());
+
+    this->deliver(record.channelId);
+}
+
+void ReplayMessenger::deliver(aasdk::messenger::ChannelId channelId)
+{
+    auto& messages = messages_[channelId];
+    auto& promises = receivePromises_[channelId];
+
+    while(!messages.empty() && !promises.empty())
+    {
+        promises.front()->resolve(std::move(messages.front()));
+        promises.pop_front();
+        messages.pop_front();
+    }
+
+    this->checkFinished();
+}
+
+void ReplayMessenger::checkFinished()
+{
+    if(!exhausted_ || promise_ == nullptr)
+    {
+        return;
+    }
+
+    for(const auto& channelMessages : messages_)
+    {
+        if(!channelMessages.second.empty())
+        {
+            return;
+        }
+    }
+
+    promise_->resolve();
+    promise_.reset();
+}
+
+}
+}
+}
+}
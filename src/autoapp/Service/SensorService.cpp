@@ -94,6 +94,10 @@ void SensorService::resume()
     });
 }
 
+void SensorService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum)
+{
+}
+
 void SensorService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response)
 {
     OPENAUTO_LOG(info) << "[SensorService] fill features.";
@@ -107,6 +111,11 @@ void SensorService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryRespons
     sensorChannel->add_sensors()->set_type(aasdk::proto::enums::SensorType::NIGHT_DATA);
 }
 
+aasdk::messenger::ChannelId SensorService::getChannelId() const
+{
+    return channel_->getId();
+}
+
 void SensorService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
     OPENAUTO_LOG(info) << "[SensorService] open request, priority: " << request.priority();
@@ -36,6 +36,8 @@
 #include <f1x/openauto/autoapp/Projection/RtAudioOutput.hpp>
 #include <f1x/openauto/autoapp/Projection/QtAudioOutput.hpp>
 #include <f1x/openauto/autoapp/Projection/GstAudioOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/AlsaAudioOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/MixerAudioOutput.hpp>
 #include <f1x/openauto/autoapp/Projection/QtAudioInput.hpp>
 #include <f1x/openauto/autoapp/Projection/InputDevice.hpp>
 #include <f1x/openauto/autoapp/Projection/LocalBluetoothDevice.hpp>
@@ -53,22 +55,31 @@ namespace autoapp
 namespace service
 {
 
-ServiceFactory::ServiceFactory(boost::asio::io_service& ioService, configuration::IConfiguration::Pointer configuration)
-    : ioService_(ioService)
+ServiceFactory::ServiceFactory(ThreadTopology& threadTopology, configuration::IConfiguration::Pointer configuration)
+    : threadTopology_(threadTopology)
     , configuration_(std::move(configuration))
+    , audioOutputPool_(std::make_shared<projection::AudioOutputPool>())
+    , echoReference_(std::make_shared<projection::EchoReference>(projection::AudioMixer::cSampleRate, projection::AudioMixer::cChannelCount, 16000))
 {
 
 }
 
-ServiceList ServiceFactory::create(aasdk::messenger::IMessenger::Pointer messenger)
+ServiceList ServiceFactory::create(aasdk::messenger::IMessenger::Pointer messenger, StartupTimeline::Pointer timeline)
 {
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
     ServiceList serviceList;
 
     projection::IAudioInput::Pointer audioInput(new projection::QtAudioInput(1, 16, 16000), std::bind(&QObject::deleteLater, std::placeholders::_1));
-    serviceList.emplace_back(std::make_shared<AudioInputService>(ioService_, messenger, std::move(audioInput)));
-    this->createAudioServices(serviceList, messenger);
-    serviceList.emplace_back(std::make_shared<SensorService>(ioService_, messenger));
-    serviceList.emplace_back(this->createVideoService(messenger));
+    projection::AudioInputProcessor::Pointer audioInputProcessor;
+    if(configuration_->getAudioInputProcessing())
+    {
+        audioInputProcessor = std::make_shared<projection::AudioInputProcessor>(audioInput->getSampleRate(), echoReference_);
+    }
+    serviceList.emplace_back(std::make_shared<AudioInputService>(threadTopology_.getIOService(ExecutorClass::CAPTURE), messenger, std::move(audioInput), std::move(audioInputProcessor)));
+    std::vector<projection::MediaClock::Pointer> mediaClocks;
+    this->createAudioServices(serviceList, messenger, mediaClocks);
+    serviceList.emplace_back(std::make_shared<SensorService>(threadTopology_.getIOService(ExecutorClass::CONTROL), messenger));
+    serviceList.emplace_back(this->createVideoService(messenger, std::move(mediaClocks), std::move(timeline)));
     serviceList.emplace_back(this->createBluetoothService(messenger));
     serviceList.emplace_back(this->createInputService(messenger));
     serviceList.emplace_back(std::make_shared<WifiService>(configuration_));
@@ -76,7 +87,7 @@ ServiceList ServiceFactory::create(aasdk::messenger::IMessenger::Pointer messeng
     return serviceList;
 }
 
-IService::Pointer ServiceFactory::createVideoService(aasdk::messenger::IMessenger::Pointer messenger)
+IService::Pointer ServiceFactory::createVideoService(aasdk::messenger::IMessenger::Pointer messenger, std::vector<projection::MediaClock::Pointer> mediaClocks, StartupTimeline::Pointer timeline)
 {
 #ifdef USE_OMX
     auto videoOutput(std::make_shared<projection::OMXVideoOutput>(configuration_));
@@ -85,7 +96,7 @@ IService::Pointer ServiceFactory::createVideoService(aasdk::messenger::IMessenge
 #else
     projection::IVideoOutput::Pointer videoOutput(new projection::QtVideoOutput(configuration_), std::bind(&QObject::deleteLater, std::placeholders::_1));
 #endif
-    return std::make_shared<VideoService>(ioService_, messenger, std::move(videoOutput));
+    return std::make_shared<VideoService>(threadTopology_.getIOService(ExecutorClass::VIDEO), messenger, std::move(videoOutput), std::move(mediaClocks), configuration_, std::move(timeline));
 }
 
 IService::Pointer ServiceFactory::createBluetoothService(aasdk::messenger::IMessenger::Pointer messenger)
@@ -106,7 +117,7 @@ IService::Pointer ServiceFactory::createBluetoothService(aasdk::messenger::IMess
         break;
     }
 
-    return std::make_shared<BluetoothService>(ioService_, messenger, std::move(bluetoothDevice));
+    return std::make_shared<BluetoothService>(threadTopology_.getIOService(ExecutorClass::CONTROL), messenger, std::move(bluetoothDevice));
 }
 
 IService::Pointer ServiceFactory::createInputService(aasdk::messenger::IMessenger::Pointer messenger)
@@ -162,46 +173,108 @@ IService::Pointer ServiceFactory::createInputService(aasdk::messenger::IMessenge
     QRect screenGeometry = screen == nullptr ? QRect(0, 0, 1, 1) : screen->geometry();
     projection::IInputDevice::Pointer inputDevice(std::make_shared<projection::InputDevice>(*QApplication::instance(), configuration_, std::move(screenGeometry), std::move(videoGeometry)));
 
-    return std::make_shared<InputService>(ioService_, messenger, std::move(inputDevice));
+    return std::make_shared<InputService>(threadTopology_.getIOService(ExecutorClass::INPUT), messenger, std::move(inputDevice));
 }
 
-static projection::IAudioOutput::Pointer createAudioOutput(configuration::AudioOutputBackendType backend, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+static projection::IAudioOutput::Pointer createAudioOutput(configuration::AudioOutputBackendType backend, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, uint32_t targetLatency,
+                                                          uint32_t periodSize, uint32_t periodCount)
 {
     switch (backend) {
         case configuration::AudioOutputBackendType::RTAUDIO:
-            return std::make_shared<projection::RtAudioOutput>(channelCount, sampleSize, sampleRate);
+            return std::make_shared<projection::RtAudioOutput>(channelCount, sampleSize, sampleRate, targetLatency);
         case configuration::AudioOutputBackendType::QT:
             return projection::IAudioOutput::Pointer(
-                new projection::QtAudioOutput(channelCount, sampleSize, sampleRate),
+                new projection::QtAudioOutput(channelCount, sampleSize, sampleRate, targetLatency),
                 std::bind(&QObject::deleteLater, std::placeholders::_1));
         #ifdef USE_GSTREAMER
         case configuration::AudioOutputBackendType::GSTREAMER:
-            return std::make_shared<projection::GstAudioOutput>(channelCount, sampleSize, sampleRate);
+            return std::make_shared<projection::GstAudioOutput>(channelCount, sampleSize, sampleRate, targetLatency);
+        #endif
+        #ifdef USE_ALSA
+        case configuration::AudioOutputBackendType::ALSA:
+            return std::make_shared<projection::AlsaAudioOutput>("default", channelCount, sampleSize, sampleRate, targetLatency, periodSize, periodCount);
+        case configuration::AudioOutputBackendType::PIPEWIRE:
+            // Provided by pipewire-alsa; goes straight to the PipeWire graph
+            // instead of through whatever "default" is routed to.
+            return std::make_shared<projection::AlsaAudioOutput>("pipewire", channelCount, sampleSize, sampleRate, targetLatency, periodSize, periodCount);
         #endif
         default:
             OPENAUTO_LOG(warning) << "[ServiceFactory::createAudioOutput] "
                                      "unknown or unavailable audio output "
                                   << static_cast<uint32_t>(backend);
-            return createAudioOutput(configuration::AudioOutputBackendType::QT, channelCount, sampleSize, sampleRate);
+            return createAudioOutput(configuration::AudioOutputBackendType::QT, channelCount, sampleSize, sampleRate, targetLatency, periodSize, periodCount);
     }
 }
 
-void ServiceFactory::createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger)
+void ServiceFactory::createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger, std::vector<projection::MediaClock::Pointer>& mediaClocks)
 {
+    const auto backend = configuration_->getAudioOutputBackendType();
+    const auto targetLatency = configuration_->getAudioJitterBufferLatency();
+    const auto maxUnacked = configuration_->getAudioMaxUnacked();
+    const auto periodSize = configuration_->getAudioPeriodSize();
+    const auto periodCount = configuration_->getAudioPeriodCount();
+
+    const bool keepOutputsOpen = configuration_->getAudioKeepOutputsOpen();
+
+    if(!keepOutputsOpen)
+    {
+        audioOutputPool_->clear();
+        audioMixer_.reset();
+    }
+
+    // All channels share one mixer and so one device stream; speech ducks
+    // the others while it plays. Pooled outputs keep using the mixer they
+    // were created on, so it is shared across sessions as well.
+    projection::AudioMixer::Pointer mixer;
+    if(backend == configuration::AudioOutputBackendType::MIXER)
+    {
+        if(audioMixer_ == nullptr || !keepOutputsOpen)
+        {
+            audioMixer_ = std::make_shared<projection::AudioMixer>(configuration_->getAudioMixerDuckLevel() / 100.0f);
+            audioMixer_->setEchoReference(echoReference_);
+        }
+
+        mixer = audioMixer_;
+    }
+
+    auto createOutput = [&](const std::string& role, uint32_t channelCount, uint32_t sampleRate, uint32_t gain, bool ducksOthers) -> projection::IAudioOutput::Pointer {
+        auto factory = [&]() -> projection::IAudioOutput::Pointer {
+            if(mixer != nullptr)
+            {
+                return std::make_shared<projection::MixerAudioOutput>(mixer, channelCount, sampleRate, targetLatency, gain / 100.0f, ducksOthers);
+            }
+
+            return createAudioOutput(backend, channelCount, 16, sampleRate, targetLatency, periodSize, periodCount);
+        };
+
+        if(!keepOutputsOpen)
+        {
+            return factory();
+        }
+
+        const auto signature = std::to_string(static_cast<uint32_t>(backend)) + "/" + std::to_string(targetLatency) + "/" + std::to_string(gain)
+            + "/" + std::to_string(periodSize) + "/" + std::to_string(periodCount);
+        return audioOutputPool_->acquire(role, signature, factory);
+    };
+
     if(configuration_->musicAudioChannelEnabled())
     {
-        auto mediaAudioOutput = createAudioOutput(configuration_->getAudioOutputBackendType(), 2, 16, 48000);
-        serviceList.emplace_back(std::make_shared<MediaAudioService>(ioService_, messenger, std::move(mediaAudioOutput)));
+        auto mediaAudioOutput = createOutput("media", 2, 48000, configuration_->getAudioMixerMediaGain(), false);
+        // The mixer already turns media down while speech plays through it.
+        const float duckLevel = mixer != nullptr ? 1.0f : configuration_->getAudioFocusDuckLevel() / 100.0f;
+        mediaClocks.push_back(mediaAudioOutput->getMediaClock());
+        serviceList.emplace_back(std::make_shared<MediaAudioService>(threadTopology_.getIOService(ExecutorClass::AUDIO), messenger, std::move(mediaAudioOutput), maxUnacked, duckLevel));
     }
 
     if(configuration_->speechAudioChannelEnabled())
     {
-        auto speechAudioOutput = createAudioOutput(configuration_->getAudioOutputBackendType(), 1, 16, 16000);
-        serviceList.emplace_back(std::make_shared<SpeechAudioService>(ioService_, messenger, std::move(speechAudioOutput)));
+        auto speechAudioOutput = createOutput("speech", 1, 16000, configuration_->getAudioMixerSpeechGain(), true);
+        mediaClocks.push_back(speechAudioOutput->getMediaClock());
+        serviceList.emplace_back(std::make_shared<SpeechAudioService>(threadTopology_.getIOService(ExecutorClass::AUDIO), messenger, std::move(speechAudioOutput), maxUnacked));
     }
 
-    auto systemAudioOutput = createAudioOutput(configuration_->getAudioOutputBackendType(), 1, 16, 16000);
-    serviceList.emplace_back(std::make_shared<SystemAudioService>(ioService_, messenger, std::move(systemAudioOutput)));
+    auto systemAudioOutput = createOutput("system", 1, 16000, configuration_->getAudioMixerSystemGain(), false);
+    serviceList.emplace_back(std::make_shared<SystemAudioService>(threadTopology_.getIOService(ExecutorClass::AUDIO), messenger, std::move(systemAudioOutput), maxUnacked));
 }
 
 }
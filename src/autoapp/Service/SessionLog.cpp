@@ -0,0 +1,161 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstring>
+#include <f1x/openauto/Common/Log.hpp>
+#include <f1x/openauto/Common/LittleEndian.hpp>
+#include <f1x/openauto/autoapp/Service/SessionLog.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+namespace
+{
+
+const char cMagic[] = {'O', 'A', 'S', 'L'};
+const uint32_t cVersion = 1;
+// Well above the largest message aasdk reassembles.
+const uint32_t cMaxPayloadSize = 16 * 1024 * 1024;
+
+}
+
+bool SessionLogWriter::open(const std::string& path)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    file_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!file_.is_open())
+    {
+        OPENAUTO_LOG(error) << "[SessionLogWriter] cannot open " << path;
+        return false;
+    }
+
+    file_.write(cMagic, sizeof(cMagic));
+    common::writeLittleEndian<uint32_t>(file_, cVersion);
+    start_ = std::chrono::steady_clock::now();
+
+    OPENAUTO_LOG(info) << "[SessionLogWriter] capturing session to " << path;
+    return true;
+}
+
+void SessionLogWriter::write(SessionLogDirection direction, const aasdk::messenger::Message& message)
+{
+    const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+    const auto& payload = message.getPayload();
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(!file_.is_open())
+    {
+        return;
+    }
+
+    common::writeLittleEndian<uint64_t>(file_, time);
+    common::writeLittleEndian<uint8_t>(file_, static_cast<uint8_t>(direction));
+    common::writeLittleEndian<uint8_t>(file_, static_cast<uint8_t>(message.getChannelId()));
+    common::writeLittleEndian<uint8_t>(file_, static_cast<uint8_t>(message.getEncryptionType()));
+    common::writeLittleEndian<uint8_t>(file_, static_cast<uint8_t>(message.getType()));
+    common::writeLittleEndian<uint32_t>(file_, static_cast<uint32_t>(payload.size()));
+    file_.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+    if(!file_)
+    {
+        OPENAUTO_LOG(error) << "[SessionLogWriter] write failed, capture stopped.";
+        file_.close();
+    }
+}
+
+bool SessionLogReader::open(const std::string& path)
+{
+    file_.open(path, std::ios::in | std::ios::binary);
+
+    if(!file_.is_open())
+    {
+        OPENAUTO_LOG(error) << "[SessionLogReader] cannot open " << path;
+        return false;
+    }
+
+    char magic[sizeof(cMagic)] = {};
+    uint32_t version = 0;
+
+    if(!file_.read(magic, sizeof(magic)) || std::memcmp(magic, cMagic, sizeof(cMagic)) != 0)
+    {
+        OPENAUTO_LOG(error) << "[SessionLogReader] " << path << " is not a session log.";
+        return false;
+    }
+
+    if(!common::readLittleEndian(file_, version) || version != cVersion)
+    {
+        OPENAUTO_LOG(error) << "[SessionLogReader] unsupported log version " << version;
+        return false;
+    }
+
+    return true;
+}
+
+bool SessionLogReader::read(SessionRecord& record)
+{
+    uint8_t direction = 0;
+    uint8_t channelId = 0;
+    uint8_t encryptionType = 0;
+    uint8_t messageType = 0;
+    uint32_t size = 0;
+
+    if(!common::readLittleEndian(file_, record.time)
+       || !common::readLittleEndian(file_, direction)
+       || !common::readLittleEndian(file_, channelId)
+       || !common::readLittleEndian(file_, encryptionType)
+       || !common::readLittleEndian(file_, messageType)
+       || !common::readLittleEndian(file_, size))
+    {
+        return false;
+    }
+
+    if(size > cMaxPayloadSize)
+    {
+        OPENAUTO_LOG(error) << "[SessionLogReader] corrupt record, payload size: " << size;
+        return false;
+    }
+
+    record.direction = static_cast<SessionLogDirection>(direction);
+    record.channelId = static_cast<aasdk::messenger::ChannelId>(channelId);
+    record.encryptionType = static_cast<aasdk::messenger::EncryptionType>(encryptionType);
+    record.messageType = static_cast<aasdk::messenger::MessageType>(messageType);
+    record.payload.resize(size);
+
+    if(!file_.read(reinterpret_cast<char*>(record.payload.data()), size))
+    {
+        OPENAUTO_LOG(error) << "[SessionLogReader] truncated record.";
+        return false;
+    }
+
+    return true;
+}
+
+}
+}
+}
+}
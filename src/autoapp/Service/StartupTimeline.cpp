@@ -0,0 +1,77 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <f1x/openauto/autoapp/Service/StartupTimeline.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+StartupTimeline::StartupTimeline()
+    : start_(Clock::now())
+    , logged_(false)
+{
+}
+
+void StartupTimeline::mark(const std::string& milestone)
+{
+    const auto offset = Clock::now() - start_;
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    const auto found = std::find_if(milestones_.begin(), milestones_.end(),
+        [&](const std::pair<std::string, Clock::duration>& entry) { return entry.first == milestone; });
+
+    if(found == milestones_.end())
+    {
+        milestones_.emplace_back(milestone, offset);
+    }
+}
+
+void StartupTimeline::log()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(logged_)
+    {
+        return;
+    }
+
+    logged_ = true;
+
+    std::ostringstream timeline;
+    for(const auto& entry : milestones_)
+    {
+        timeline << ", " << entry.first << ": +" << std::chrono::duration_cast<std::chrono::milliseconds>(entry.second).count() << "ms";
+    }
+
+    OPENAUTO_LOG(info) << "[StartupTimeline] session start" << timeline.str();
+}
+
+}
+}
+}
+}
@@ -0,0 +1,362 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <f1x/openauto/autoapp/Service/ThreadTopology.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+// Every service runs on its own strand, so workers beyond this only wait.
+static constexpr size_t cMaxIOServiceWorkers = 4;
+static constexpr std::chrono::milliseconds cProbeInterval(100);
+
+static const char* executorClassName(ExecutorClass executorClass)
+{
+    switch(executorClass)
+    {
+    case ExecutorClass::VIDEO:
+        return "video";
+    case ExecutorClass::AUDIO:
+        return "audio";
+    case ExecutorClass::CAPTURE:
+        return "capture";
+    case ExecutorClass::INPUT:
+        return "input";
+    default:
+        return "io";
+    }
+}
+
+ThreadTopology::Executor::Executor(boost::asio::io_service* sharedIOService, size_t threadCount, int priority)
+    : ownedIOService(sharedIOService == nullptr ? std::make_unique<boost::asio::io_service>() : std::unique_ptr<boost::asio::io_service>())
+    , work(ownedIOService == nullptr ? std::unique_ptr<boost::asio::io_service::work>() : std::make_unique<boost::asio::io_service::work>(*ownedIOService))
+    , ioService(ownedIOService == nullptr ? *sharedIOService : *ownedIOService)
+    , threadCount(threadCount)
+    , priority(priority)
+    , probeStrand(ioService)
+    , probeTimer(ioService)
+    , probing(false)
+{
+
+}
+
+ThreadTopology::ThreadTopology(boost::asio::io_service& ioService, libusb_context* usbContext, configuration::IConfiguration::Pointer configuration)
+    : ioService_(ioService)
+    , configuration_(std::move(configuration))
+    , cpuCount_(std::max(std::thread::hardware_concurrency(), 1u))
+    , activeTransport_(TransportType::NONE)
+    , parkTarget_(0)
+    , parkedWorkers_(0)
+    , stopping_(false)
+{
+    // Leave one core to the UI thread and the decoder.
+    ioServiceWorkerCount_ = configuration_->getThreadIOServiceWorkers() > 0
+            ? configuration_->getThreadIOServiceWorkers()
+            : std::min(std::max<size_t>(cpuCount_ - 1, 2), cMaxIOServiceWorkers);
+
+    if(usbContext != nullptr)
+    {
+        usbEventSource_ = std::make_unique<USBEventSource>(ioService_, usbContext);
+    }
+
+    // Workers keep off core 0, so the UI thread, which is not pinned itself,
+    // always finds it free.
+    if(configuration_->getThreadCpuAffinity() && cpuCount_ >= 2)
+    {
+        for(unsigned int cpu = 1; cpu < cpuCount_; ++cpu)
+        {
+            ioServiceCpus_.push_back(cpu);
+        }
+    }
+
+    const int mediaPriority = configuration_->getThreadMediaPriority();
+
+    if(configuration_->getThreadServiceExecutors())
+    {
+        // One thread per class is enough as each service is strand-bound.
+        // Video gets a second one so that a write blocking on its output
+        // strand leaves a thread to receive and ack the next frame. Capture
+        // runs echo cancellation, so it is kept away from playback and below
+        // it in priority.
+        executors_[static_cast<size_t>(ExecutorClass::VIDEO)] = std::make_unique<Executor>(nullptr, 2, mediaPriority);
+        executors_[static_cast<size_t>(ExecutorClass::AUDIO)] = std::make_unique<Executor>(nullptr, 1, mediaPriority);
+        executors_[static_cast<size_t>(ExecutorClass::CAPTURE)] = std::make_unique<Executor>(nullptr, 1, 0);
+        executors_[static_cast<size_t>(ExecutorClass::INPUT)] = std::make_unique<Executor>(nullptr, 1, 0);
+        executors_[static_cast<size_t>(ExecutorClass::CONTROL)] = std::make_unique<Executor>(&ioService_, ioServiceWorkerCount_, 0);
+    }
+    else
+    {
+        // The media strands share this pool with everything else.
+        executors_[static_cast<size_t>(ExecutorClass::CONTROL)] = std::make_unique<Executor>(&ioService_, ioServiceWorkerCount_, mediaPriority);
+    }
+}
+
+void ThreadTopology::start()
+{
+    OPENAUTO_LOG(info) << "[ThreadTopology] cores: " << cpuCount_
+                       << ", io service workers: " << ioServiceWorkerCount_
+                       << ", service executors: " << (executors_[static_cast<size_t>(ExecutorClass::VIDEO)] != nullptr ? "on" : "off")
+                       << ", cpu affinity: " << (ioServiceCpus_.empty() ? "off" : "on")
+                       << ", media priority: " << configuration_->getThreadMediaPriority();
+
+    if(usbEventSource_ != nullptr)
+    {
+        usbEventSource_->start();
+    }
+
+    for(size_t i = 0; i < cExecutorClassCount; ++i)
+    {
+        if(executors_[i] == nullptr)
+        {
+            continue;
+        }
+
+        for(size_t j = 0; j < executors_[i]->threadCount; ++j)
+        {
+            const auto name = std::string(executorClassName(static_cast<ExecutorClass>(i))) + "-" + std::to_string(j);
+            threadPool_.emplace_back(&ThreadTopology::executorWorker, this, std::ref(*executors_[i]), name);
+        }
+    }
+
+    this->resizeIOServicePool(activeTransport_);
+}
+
+void ThreadTopology::stop()
+{
+    if(usbEventSource_ != nullptr)
+    {
+        usbEventSource_->stop();
+    }
+
+    {
+        std::lock_guard<decltype(parkMutex_)> lock(parkMutex_);
+        stopping_ = true;
+    }
+    parkChanged_.notify_all();
+
+    for(auto& executor : executors_)
+    {
+        if(executor != nullptr)
+        {
+            executor->ioService.stop();
+        }
+    }
+}
+
+void ThreadTopology::join()
+{
+    std::for_each(threadPool_.begin(), threadPool_.end(), std::bind(&std::thread::join, std::placeholders::_1));
+    threadPool_.clear();
+}
+
+void ThreadTopology::setActiveTransport(TransportType transport)
+{
+    const auto previousTransport = activeTransport_.exchange(transport);
+
+    if(previousTransport == transport)
+    {
+        return;
+    }
+
+    this->resizeIOServicePool(transport);
+
+    for(size_t i = 0; i < cExecutorClassCount; ++i)
+    {
+        if(executors_[i] == nullptr)
+        {
+            continue;
+        }
+
+        if(previousTransport != TransportType::NONE)
+        {
+            this->stopProbe(*executors_[i], static_cast<ExecutorClass>(i));
+        }
+
+        if(transport != TransportType::NONE)
+        {
+            this->startProbe(*executors_[i]);
+        }
+    }
+}
+
+size_t ThreadTopology::getIOServiceWorkerCount() const
+{
+    return ioServiceWorkerCount_;
+}
+
+boost::asio::io_service& ThreadTopology::getIOService(ExecutorClass executorClass)
+{
+    const auto& executor = executors_[static_cast<size_t>(executorClass)];
+    return executor != nullptr ? executor->ioService : ioService_;
+}
+
+const common::LatencyHistogram& ThreadTopology::getQueueDelay(ExecutorClass executorClass) const
+{
+    const auto& executor = executors_[static_cast<size_t>(executorClass)];
+    return executor != nullptr ? executor->queueDelay : executors_[static_cast<size_t>(ExecutorClass::CONTROL)]->queueDelay;
+}
+
+void ThreadTopology::executorWorker(Executor& executor, const std::string& name)
+{
+    pthread_setname_np(pthread_self(), name.c_str());
+
+    this->pinThread(ioServiceCpus_, name);
+
+    if(executor.priority > 0)
+    {
+        this->promoteThread(executor.priority, name);
+    }
+
+    executor.ioService.run();
+}
+
+// Without a session the shared pool only waits for devices and connections.
+// A TCP session has no USB transfers to reap, so it does with one worker less
+// than a USB session.
+void ThreadTopology::resizeIOServicePool(TransportType transport)
+{
+    size_t activeWorkers = 1;
+
+    if(transport == TransportType::USB)
+    {
+        activeWorkers = ioServiceWorkerCount_;
+    }
+    else if(transport == TransportType::TCP)
+    {
+        activeWorkers = std::max<size_t>(ioServiceWorkerCount_ - 1, 1);
+    }
+
+    activeWorkers = std::min(activeWorkers, ioServiceWorkerCount_);
+
+    {
+        std::lock_guard<decltype(parkMutex_)> lock(parkMutex_);
+        parkTarget_ = ioServiceWorkerCount_ - activeWorkers;
+
+        for(; parkedWorkers_ < parkTarget_; ++parkedWorkers_)
+        {
+            ioService_.post(std::bind(&ThreadTopology::park, this));
+        }
+    }
+
+    parkChanged_.notify_all();
+    OPENAUTO_LOG(info) << "[ThreadTopology] io service workers active: " << activeWorkers << "/" << ioServiceWorkerCount_;
+}
+
+// Holds the worker that picked it up until the pool grows again. Surplus
+// handlers leave as soon as they run, so a shrink never strands one.
+void ThreadTopology::park()
+{
+    std::unique_lock<decltype(parkMutex_)> lock(parkMutex_);
+    parkChanged_.wait(lock, [this]() { return stopping_ || parkedWorkers_ > parkTarget_; });
+    --parkedWorkers_;
+}
+
+void ThreadTopology::startProbe(Executor& executor)
+{
+    executor.probeStrand.post([this, &executor]() {
+        executor.queueDelay.reset();
+        executor.probing = true;
+        this->scheduleProbe(executor);
+    });
+}
+
+void ThreadTopology::stopProbe(Executor& executor, ExecutorClass executorClass)
+{
+    executor.probeStrand.post([&executor, executorClass]() {
+        executor.probing = false;
+        executor.probeTimer.cancel();
+
+        const auto& queueDelay = executor.queueDelay;
+        if(queueDelay.getCount() > 0)
+        {
+            OPENAUTO_LOG(info) << "[ThreadTopology] " << executorClassName(executorClass)
+                               << " queue delay p50: " << queueDelay.getPercentile(50) << "us"
+                               << ", p99: " << queueDelay.getPercentile(99) << "us"
+                               << ", max: " << queueDelay.getPercentile(100) << "us";
+        }
+    });
+}
+
+// A timer handler queues behind everything else posted to the io_service,
+// so how late it runs is how long any handler of that class waits. The strand
+// is only used by the probe, so it adds no wait of its own.
+void ThreadTopology::scheduleProbe(Executor& executor)
+{
+    const auto deadline = std::chrono::steady_clock::now() + cProbeInterval;
+    executor.probeTimer.expires_at(deadline);
+    executor.probeTimer.async_wait(executor.probeStrand.wrap([this, &executor, deadline](const boost::system::error_code& error) {
+        if(error == boost::asio::error::operation_aborted || !executor.probing)
+        {
+            return;
+        }
+
+        const auto delay = std::chrono::steady_clock::now() - deadline;
+        executor.queueDelay.record(std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(delay).count(), 0));
+        this->scheduleProbe(executor);
+    }));
+}
+
+void ThreadTopology::pinThread(const std::vector<unsigned int>& cpus, const std::string& name)
+{
+    if(cpus.empty())
+    {
+        return;
+    }
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+
+    for(const auto& cpu : cpus)
+    {
+        CPU_SET(cpu, &cpuSet);
+    }
+
+    if(sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0)
+    {
+        OPENAUTO_LOG(warning) << "[ThreadTopology] Failed to pin " << name << ", what: " << strerror(errno);
+    }
+}
+
+void ThreadTopology::promoteThread(int priority, const std::string& name)
+{
+    sched_param param{};
+    param.sched_priority = std::min(priority, sched_get_priority_max(SCHED_FIFO));
+
+    const auto result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if(result != 0)
+    {
+        OPENAUTO_LOG(warning) << "[ThreadTopology] Failed to make " << name << " real-time, what: " << strerror(result);
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,294 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <poll.h>
+#include <cstdlib>
+#include <vector>
+#include <f1x/openauto/autoapp/Service/USBEventSource.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace service
+{
+
+USBEventSource::Watch::Watch(boost::asio::io_service& ioService, int fd, short events)
+    : descriptor(ioService, fd)
+    , fd(fd)
+    , events(events)
+{
+
+}
+
+USBEventSource::Watch::~Watch()
+{
+    // libusb owns the file descriptor.
+    if(descriptor.is_open())
+    {
+        descriptor.release();
+    }
+}
+
+USBEventSource::USBEventSource(boost::asio::io_service& ioService, libusb_context* usbContext)
+    : ioService_(ioService)
+    , usbContext_(usbContext)
+    , strand_(ioService_)
+    , timer_(ioService_)
+    , handlesTimeouts_(false)
+    , started_(false)
+{
+
+}
+
+void USBEventSource::start()
+{
+    handlesTimeouts_ = libusb_pollfds_handle_timeouts(usbContext_) != 0;
+    started_ = true;
+
+    // Set before the initial list is taken so that no descriptor is missed;
+    // addWatch() ignores the ones reported twice.
+    libusb_set_pollfd_notifiers(usbContext_, &USBEventSource::onPollfdAdded, &USBEventSource::onPollfdRemoved, this);
+
+    const libusb_pollfd** pollfds = libusb_get_pollfds(usbContext_);
+    if(pollfds == nullptr)
+    {
+        OPENAUTO_LOG(error) << "[USBEventSource] libusb does not expose its file descriptors.";
+        return;
+    }
+
+    size_t count = 0;
+    for(; pollfds[count] != nullptr; ++count)
+    {
+        this->addWatch(pollfds[count]->fd, pollfds[count]->events);
+    }
+
+#if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000104
+    libusb_free_pollfds(pollfds);
+#else
+    free(pollfds);
+#endif
+
+    OPENAUTO_LOG(info) << "[USBEventSource] watching " << count << " descriptors"
+                       << (handlesTimeouts_ ? "." : ", timeouts handled by a timer.");
+
+    if(!handlesTimeouts_)
+    {
+        this->scheduleTimeout();
+    }
+}
+
+void USBEventSource::stop()
+{
+    started_ = false;
+    libusb_set_pollfd_notifiers(usbContext_, nullptr, nullptr, nullptr);
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    for(auto& watch : watches_)
+    {
+        watch.second->descriptor.release();
+    }
+
+    watches_.clear();
+    timer_.cancel();
+}
+
+void USBEventSource::addWatch(int fd, short events)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(watches_.count(fd) != 0)
+    {
+        return;
+    }
+
+    std::shared_ptr<Watch> watch;
+
+    try
+    {
+        watch = std::make_shared<Watch>(ioService_, fd, events);
+    }
+    catch(const boost::system::system_error& e)
+    {
+        OPENAUTO_LOG(error) << "[USBEventSource] cannot watch descriptor " << fd << ", what: " << e.what();
+        return;
+    }
+
+    watches_.emplace(fd, watch);
+
+    // usbfs reports completed URBs as writable, libusb's own pipes and
+    // timerfd as readable.
+    if(events & POLLIN)
+    {
+        this->arm(watch, boost::asio::posix::stream_descriptor::wait_read);
+    }
+
+    if(events & POLLOUT)
+    {
+        this->arm(watch, boost::asio::posix::stream_descriptor::wait_write);
+    }
+}
+
+// Called by libusb before it closes the descriptor, so the reactor must let
+// go of it right away rather than from a posted handler.
+void USBEventSource::removeWatch(int fd)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    const auto it = watches_.find(fd);
+
+    if(it != watches_.end())
+    {
+        // A handler in flight may still hold the watch.
+        it->second->descriptor.release();
+        watches_.erase(it);
+    }
+}
+
+// mutex_ must be held.
+void USBEventSource::arm(const std::shared_ptr<Watch>& watch, boost::asio::posix::stream_descriptor::wait_type waitType)
+{
+    watch->descriptor.async_wait(waitType, strand_.wrap([this, watch, waitType](const boost::system::error_code& error) {
+        if(!error)
+        {
+            this->onReady(watch, waitType);
+        }
+    }));
+}
+
+void USBEventSource::onReady(const std::shared_ptr<Watch>& watch, boost::asio::posix::stream_descriptor::wait_type waitType)
+{
+    if(!started_)
+    {
+        return;
+    }
+
+    // Not under mutex_: libusb calls back into removeWatch() from here.
+    this->handleEvents();
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    const auto it = watches_.find(watch->fd);
+
+    if(it == watches_.end() || it->second != watch)
+    {
+        return;
+    }
+
+    // The reactor reports readiness edge-triggered and forgets an edge that
+    // comes while no wait is queued. If another thread held libusb's event
+    // lock, handleEvents() returned without polling, so check by hand, but
+    // only once the next wait is queued; anything after that fires it.
+    this->arm(watch, waitType);
+
+    if(this->hasPendingEvents())
+    {
+        strand_.post(std::bind(&USBEventSource::drainEvents, this));
+    }
+}
+
+// Handles events for as long as a descriptor stays ready, without queueing
+// further waits.
+void USBEventSource::drainEvents()
+{
+    if(!started_)
+    {
+        return;
+    }
+
+    this->handleEvents();
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(this->hasPendingEvents())
+    {
+        strand_.post(std::bind(&USBEventSource::drainEvents, this));
+    }
+}
+
+// mutex_ must be held.
+bool USBEventSource::hasPendingEvents()
+{
+    std::vector<pollfd> pollfds;
+    pollfds.reserve(watches_.size());
+
+    for(const auto& watch : watches_)
+    {
+        pollfds.push_back(pollfd{watch.second->fd, watch.second->events, 0});
+    }
+
+    return ::poll(pollfds.data(), pollfds.size(), 0) > 0;
+}
+
+void USBEventSource::handleEvents()
+{
+    timeval timeout{0, 0};
+    const auto result = libusb_handle_events_timeout_completed(usbContext_, &timeout, nullptr);
+
+    if(result != LIBUSB_SUCCESS && result != LIBUSB_ERROR_INTERRUPTED)
+    {
+        OPENAUTO_LOG(warning) << "[USBEventSource] event handling failed, what: " << libusb_error_name(result);
+    }
+
+    if(!handlesTimeouts_)
+    {
+        this->scheduleTimeout();
+    }
+}
+
+// Only needed where libusb cannot use a timerfd for transfer timeouts.
+void USBEventSource::scheduleTimeout()
+{
+    timeval timeout;
+    if(libusb_get_next_timeout(usbContext_, &timeout) != 1)
+    {
+        return;
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(!started_)
+    {
+        return;
+    }
+
+    timer_.expires_from_now(std::chrono::seconds(timeout.tv_sec) + std::chrono::microseconds(timeout.tv_usec));
+    timer_.async_wait(strand_.wrap([this](const boost::system::error_code& error) {
+        if(!error && started_)
+        {
+            this->handleEvents();
+        }
+    }));
+}
+
+void USBEventSource::onPollfdAdded(int fd, short events, void* userData)
+{
+    static_cast<USBEventSource*>(userData)->addWatch(fd, events);
+}
+
+void USBEventSource::onPollfdRemoved(int fd, void* userData)
+{
+    static_cast<USBEventSource*>(userData)->removeWatch(fd);
+}
+
+}
+}
+}
+}
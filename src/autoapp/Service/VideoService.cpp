@@ -18,6 +18,7 @@
 
 #include <f1x/openauto/Common/Log.hpp>
 #include <f1x/openauto/autoapp/Service/VideoService.hpp>
+#include <algorithm>
 #include <fstream>
 
 namespace f1x
@@ -29,13 +30,40 @@ namespace autoapp
 namespace service
 {
 
-VideoService::VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput)
+// Enough to cover frames sitting in the output's decoder queue.
+static constexpr size_t cOutputHeldFrames = 16;
+
+VideoService::VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput,
+                           std::vector<projection::MediaClock::Pointer> mediaClocks, configuration::IConfiguration::Pointer configuration,
+                           StartupTimeline::Pointer timeline)
     : strand_(ioService)
+    , outputStrand_(ioService)
     , channel_(std::make_shared<aasdk::channel::av::VideoServiceChannel>(strand_, std::move(messenger)))
     , videoOutput_(std::move(videoOutput))
     , session_(-1)
+    , maxUnacked_(std::max<uint32_t>(configuration->getVideoMaxUnacked(), 1))
+    , pendingFrames_(0)
+    , deferredAcks_(0)
+    , dropPolicy_(configuration->getVideoDropThreshold())
+    , latencyTracer_(std::make_shared<projection::VideoLatencyTracer>(configuration->getVideoLatencyTracing()))
+    , dumpSignals_(ioService)
+    , capturePath_(configuration->getVideoCapturePath())
+    , timeline_(std::move(timeline))
+    , firstFrameWritten_(false)
 {
+    if(maxUnacked_ > 1)
+    {
+        // The phone never has more than maxUnacked_ frames in flight, but an
+        // output may keep the frames it is given until they are decoded.
+        bufferPool_ = projection::VideoBufferPool::create(maxUnacked_ + cOutputHeldFrames);
+    }
 
+    videoOutput_->setLatencyTracer(latencyTracer_);
+
+    if(configuration->getVideoAudioSync())
+    {
+        timestampGenerator_.setMediaClocks(std::move(mediaClocks));
+    }
 }
 
 void VideoService::start()
@@ -43,6 +71,19 @@ void VideoService::start()
     strand_.dispatch([this, self = this->shared_from_this()]() {
         OPENAUTO_LOG(info) << "[VideoService] start.";
         channel_->receive(this->shared_from_this());
+
+        if(!capturePath_.empty())
+        {
+            captureLog_.open(capturePath_);
+        }
+
+        if(latencyTracer_->isEnabled())
+        {
+#ifdef SIGUSR1
+            dumpSignals_.add(SIGUSR1);
+            this->waitForDumpSignal();
+#endif
+        }
     });
 }
 
@@ -51,6 +92,11 @@ void VideoService::stop()
     strand_.dispatch([this, self = this->shared_from_this()]() {
         OPENAUTO_LOG(info) << "[VideoService] stop.";
         videoOutput_->stop();
+
+        boost::system::error_code ec;
+        dumpSignals_.cancel(ec);
+        latencyTracer_->dump();
+        captureLog_.close();
     });
 }
 
@@ -68,11 +114,16 @@ void VideoService::resume()
     });
 }
 
+void VideoService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum)
+{
+}
+
 void VideoService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
     OPENAUTO_LOG(info) << "[VideoService] open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = videoOutput_->open() ? aasdk::proto::enums::Status::OK : aasdk::proto::enums::Status::FAIL;
     OPENAUTO_LOG(info) << "[VideoService] open status: " << status;
+    timeline_->mark("video channel open");
 
     aasdk::proto::messages::ChannelOpenResponse response;
     response.set_status(status);
@@ -88,11 +139,11 @@ void VideoService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChann
 {
     OPENAUTO_LOG(info) << "[VideoService] setup request, config index: " << request.config_index();
     const aasdk::proto::enums::AVChannelSetupStatus::Enum status = videoOutput_->init() ? aasdk::proto::enums::AVChannelSetupStatus::OK : aasdk::proto::enums::AVChannelSetupStatus::FAIL;
-    OPENAUTO_LOG(info) << "[VideoService] setup status: " << status;
+    OPENAUTO_LOG(info) << "[VideoService] setup status: " << status << ", max unacked: " << maxUnacked_;
 
     aasdk::proto::messages::AVChannelSetupResponse response;
     response.set_media_status(status);
-    response.set_max_unacked(1);
+    response.set_max_unacked(maxUnacked_);
     response.add_configs(0);
 
     auto promise = aasdk::channel::SendPromise::defer(strand_);
@@ -106,6 +157,8 @@ void VideoService::onAVChannelStartIndication(const aasdk::proto::messages::AVCh
 {
     OPENAUTO_LOG(info) << "[VideoService] start indication, session: " << indication.session();
     session_ = indication.session();
+    timestampGenerator_.reset();
+    dropPolicy_.reset();
 
     channel_->receive(this->shared_from_this());
 }
@@ -119,23 +172,109 @@ void VideoService::onAVChannelStopIndication(const aasdk::proto::messages::AVCha
 
 void VideoService::onAVMediaWithTimestampIndication(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    videoOutput_->write(timestamp, buffer);
+    this->queueFrame(timestamp, buffer);
+    channel_->receive(this->shared_from_this());
+}
 
-    aasdk::proto::messages::AVMediaAckIndication indication;
-    indication.set_session(session_);
-    indication.set_value(1);
+void VideoService::onAVMediaIndication(const aasdk::common::DataConstBuffer& buffer)
+{
+    this->queueFrame(0, buffer);
+    channel_->receive(this->shared_from_this());
+}
 
-    auto promise = aasdk::channel::SendPromise::defer(strand_);
-    promise->then([]() {}, std::bind(&VideoService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-    channel_->sendAVMediaAckIndication(indication, std::move(promise));
+void VideoService::queueFrame(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    if(captureLog_.isOpen())
+    {
+        captureLog_.write(timestamp, buffer);
+    }
 
-    channel_->receive(this->shared_from_this());
+    timestamp = timestampGenerator_.generate(timestamp);
+    latencyTracer_->record(projection::VideoLatencyTracer::Stage::RECEIVED, timestamp);
+
+    // Frames still waiting on the output strand are as good as queued in the
+    // decoder as far as latency goes.
+    if(dropPolicy_.shouldDrop(buffer, videoOutput_->getQueueDepth() + pendingFrames_))
+    {
+        // A fresh focus indication gets most phones to send an IDR early.
+        if(dropPolicy_.takeKeyframeRequest())
+        {
+            this->sendVideoFocusIndication();
+        }
+
+        this->sendAVMediaAckIndication();
+        return;
+    }
+
+    if(maxUnacked_ <= 1)
+    {
+        videoOutput_->write(timestamp, buffer);
+        this->markFirstFrame();
+        this->sendAVMediaAckIndication();
+        return;
+    }
+
+    // The payload is only borrowed from the messenger, so it has to be copied
+    // before the write is handed over to the output strand. The copy is then
+    // handed to the output as is, which saves copying it a second time.
+    auto frame = bufferPool_->acquire(buffer);
+    ++pendingFrames_;
+
+    outputStrand_.post([this, self = this->shared_from_this(), timestamp, frame = std::move(frame)]() mutable {
+        videoOutput_->writeFrame(timestamp, std::move(frame));
+        strand_.dispatch(std::bind(&VideoService::onFrameWritten, this->shared_from_this()));
+    });
+
+    // Ack as soon as the frame is queued while the decoder keeps up. Once the
+    // whole window is waiting on the output the ack is held back until a write
+    // completes, so a stalled decoder still throttles the phone.
+    if(pendingFrames_ < maxUnacked_)
+    {
+        this->sendAVMediaAckIndication();
+    }
+    else
+    {
+        ++deferredAcks_;
+    }
 }
 
-void VideoService::onAVMediaIndication(const aasdk::common::DataConstBuffer& buffer)
+void VideoService::onFrameWritten()
+{
+    --pendingFrames_;
+    this->markFirstFrame();
+
+    if(deferredAcks_ > 0)
+    {
+        --deferredAcks_;
+        this->sendAVMediaAckIndication();
+    }
+}
+
+// The session counts as started once the first frame reaches the decoder.
+void VideoService::markFirstFrame()
 {
-    videoOutput_->write(0, buffer);
+    if(!firstFrameWritten_)
+    {
+        firstFrameWritten_ = true;
+        timeline_->mark("first video frame");
+        timeline_->log();
+    }
+}
+
+// kill -USR1 dumps the latency histograms gathered so far.
+void VideoService::waitForDumpSignal()
+{
+    dumpSignals_.async_wait(strand_.wrap([this, self = this->shared_from_this()](const boost::system::error_code& e, int) {
+        if(!e)
+        {
+            latencyTracer_->dump();
+            this->waitForDumpSignal();
+        }
+    }));
+}
 
+void VideoService::sendAVMediaAckIndication()
+{
     aasdk::proto::messages::AVMediaAckIndication indication;
     indication.set_session(session_);
     indication.set_value(1);
@@ -143,8 +282,6 @@ void VideoService::onAVMediaIndication(const aasdk::common::DataConstBuffer& buf
     auto promise = aasdk::channel::SendPromise::defer(strand_);
     promise->then([]() {}, std::bind(&VideoService::onChannelError, this->shared_from_this(), std::placeholders::_1));
     channel_->sendAVMediaAckIndication(indication, std::move(promise));
-
-    channel_->receive(this->shared_from_this());
 }
 
 void VideoService::onChannelError(const aasdk::error::Error& e)
@@ -173,6 +310,11 @@ void VideoService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse
     videoConfig1->set_dpi(videoOutput_->getScreenDPI());
 }
 
+aasdk::messenger::ChannelId VideoService::getChannelId() const
+{
+    return channel_->getId();
+}
+
 void VideoService::onVideoFocusRequest(const aasdk::proto::messages::VideoFocusRequest& request)
 {
     OPENAUTO_LOG(info) << "[VideoService] video focus request, display index: " << request.disp_index()
@@ -52,6 +52,10 @@ void WifiService::resume()
 {
 }
 
+void WifiService::onAudioFocusChanged(aasdk::proto::enums::AudioFocusType::Enum)
+{
+}
+
 void WifiService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse& response)
 {
     OPENAUTO_LOG(info) << "[WifiService] fill features.";
@@ -63,6 +67,11 @@ void WifiService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse&
     channel->set_ssid(configuration_->getParamFromFile("/etc/hostapd/hostapd.conf","ssid").toStdString());
 }
 
+aasdk::messenger::ChannelId WifiService::getChannelId() const
+{
+    return aasdk::messenger::ChannelId::NONE;
+}
+
 }
 }
 }
@@ -265,6 +265,9 @@ void SettingsWindow::onSave()
     configuration_->setAudioOutputBackendType(
           ui_->radioButtonRtAudio->isChecked() ? configuration::AudioOutputBackendType::RTAUDIO
         : ui_->radioButtonQtAudio->isChecked() ? configuration::AudioOutputBackendType::QT
+        : ui_->radioButtonMixerAudio->isChecked() ? configuration::AudioOutputBackendType::MIXER
+        : ui_->radioButtonAlsaAudio->isChecked() ? configuration::AudioOutputBackendType::ALSA
+        : ui_->radioButtonPipeWireAudio->isChecked() ? configuration::AudioOutputBackendType::PIPEWIRE
         : configuration::AudioOutputBackendType::GSTREAMER);
 
     configuration_->save();
@@ -546,9 +549,16 @@ void SettingsWindow::load()
     ui_->radioButtonRtAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::RTAUDIO);
     ui_->radioButtonQtAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::QT);
     ui_->radioButtonGstAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::GSTREAMER);
+    ui_->radioButtonMixerAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::MIXER);
+    ui_->radioButtonAlsaAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::ALSA);
+    ui_->radioButtonPipeWireAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::PIPEWIRE);
 #ifndef USE_GSTREAMER
     ui_->radioButtonGstAudio->setDisabled(true);
 #endif
+#ifndef USE_ALSA
+    ui_->radioButtonAlsaAudio->setDisabled(true);
+    ui_->radioButtonPipeWireAudio->setDisabled(true);
+#endif
 
     ui_->checkBoxHardwareSave->setChecked(false);
     QStorageInfo storage("/media/USBDRIVES/CSSTORAGE");
@@ -0,0 +1,181 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <QApplication>
+#include <f1x/openauto/autoapp/Configuration/Configuration.hpp>
+#include <f1x/openauto/autoapp/Service/ReplayMessenger.hpp>
+#include <f1x/openauto/autoapp/Service/ServiceFactory.hpp>
+#include <f1x/openauto/autoapp/Service/SessionLog.hpp>
+#include <f1x/openauto/autoapp/Service/ThreadTopology.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace autoapp = f1x::openauto::autoapp;
+
+namespace
+{
+
+struct Options
+{
+    std::string path;
+    double speed = 1.0;
+    bool headless = false;
+};
+
+void printUsage(const char* name)
+{
+    std::cerr << "usage: " << name << " [--speed <factor>] [--headless] <capture>\n"
+              << "  <capture>   session log written with General.SessionCapturePath\n"
+              << "  --speed     replay faster (>1) or slower (<1) than captured; 0 replays as fast as the services go\n"
+              << "  --headless  use the offscreen Qt platform" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+
+        if(arg == "--speed" && i + 1 < argc)
+        {
+            options.speed = std::strtod(argv[++i], nullptr);
+        }
+        else if(arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if(!arg.empty() && arg[0] != '-' && options.path.empty())
+        {
+            options.path = arg;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return !options.path.empty() && options.speed >= 0;
+}
+
+void report(const autoapp::service::ReplayMessenger::Statistics& statistics, double elapsed)
+{
+    OPENAUTO_LOG(info) << "[sessionreplay] finished in " << elapsed << "s";
+
+    for(const auto& channel : statistics)
+    {
+        const auto& stats = channel.second;
+        OPENAUTO_LOG(info) << "[sessionreplay] channel: " << aasdk::messenger::channelIdToString(channel.first)
+                           << ", received: " << stats.received
+                           << " (" << stats.received / elapsed << " msg/s, "
+                           << stats.receivedBytes * 8 / elapsed / 1000000 << " Mbit/s)"
+                           << ", sent: " << stats.sent
+                           << ", dropped: " << stats.dropped
+                           << ", max backlog: " << stats.maxBacklog;
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if(!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    auto log = std::make_shared<autoapp::service::SessionLogReader>();
+    if(!log->open(options.path))
+    {
+        return 1;
+    }
+
+    if(options.headless)
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication qApplication(argc, argv);
+    auto configuration = std::make_shared<autoapp::configuration::Configuration>();
+
+    boost::asio::io_service ioService;
+    boost::asio::io_service::work work(ioService);
+    autoapp::service::ThreadTopology threadTopology(ioService, nullptr, configuration);
+    threadTopology.start();
+    // Sized like a USB session, the busiest one the replay stands in for.
+    threadTopology.setActiveTransport(autoapp::service::TransportType::USB);
+
+    autoapp::service::ServiceFactory serviceFactory(threadTopology, configuration);
+    auto messenger = std::make_shared<autoapp::service::ReplayMessenger>(ioService, log, options.speed);
+    autoapp::service::ServiceList serviceList;
+    int result = 0;
+
+    auto quit = [&qApplication, &serviceList]() {
+        for(auto& service : serviceList)
+        {
+            service->stop();
+        }
+
+        QMetaObject::invokeMethod(&qApplication, "quit", Qt::QueuedConnection);
+    };
+
+    // The outputs create their Qt objects on the application thread and wait
+    // for them when a channel opens, so the services must run off that thread.
+    ioService.post([&]() {
+        serviceList = serviceFactory.create(messenger, std::make_shared<autoapp::service::StartupTimeline>());
+
+        // The replay waits for every channel a service receives on to listen.
+        autoapp::service::ReplayMessenger::ChannelIds channelIds;
+        for(auto& service : serviceList)
+        {
+            if(service->getChannelId() != aasdk::messenger::ChannelId::NONE)
+            {
+                channelIds.insert(service->getChannelId());
+            }
+
+            service->start();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        auto promise = autoapp::service::ReplayMessenger::Promise::defer(ioService);
+        promise->then([&, start]() {
+            report(messenger->getStatistics(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            quit();
+        },
+        [&](const aasdk::error::Error& e) {
+            OPENAUTO_LOG(error) << "[sessionreplay] replay failed: " << e.what();
+            result = 1;
+            quit();
+        });
+
+        messenger->start(std::move(channelIds), std::move(promise));
+    });
+
+    qApplication.exec();
+
+    threadTopology.setActiveTransport(autoapp::service::TransportType::NONE);
+    threadTopology.stop();
+    threadTopology.join();
+
+    return result;
+}
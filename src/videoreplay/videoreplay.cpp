@@ -0,0 +1,255 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <QApplication>
+#include <f1x/openauto/autoapp/Configuration/Configuration.hpp>
+#include <f1x/openauto/autoapp/Projection/OMXVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/PresentationTimestampGenerator.hpp>
+#include <f1x/openauto/autoapp/Projection/QtVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/QuickGstVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoFrameDropPolicy.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoFrameLog.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoLatencyTracer.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoOutput.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace autoapp = f1x::openauto::autoapp;
+namespace projection = f1x::openauto::autoapp::projection;
+
+namespace
+{
+
+struct Options
+{
+    std::string path;
+    double speed = 1.0;
+    uint64_t fps = 30;
+    bool headless = false;
+    bool null = false;
+};
+
+// Swallows frames; measures the cost of the replay loop itself and lets the
+// harness run where no backend can.
+class NullVideoOutput: public projection::VideoOutput
+{
+public:
+    using projection::VideoOutput::VideoOutput;
+
+    bool open() override { return true; }
+    bool init() override { return true; }
+    void stop() override {}
+
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer&) override
+    {
+        latencyTracer_->record(projection::VideoLatencyTracer::Stage::ENQUEUED, timestamp);
+        latencyTracer_->record(projection::VideoLatencyTracer::Stage::DECODED, timestamp);
+        latencyTracer_->record(projection::VideoLatencyTracer::Stage::RENDERED, timestamp);
+    }
+};
+
+void printUsage(const char* name)
+{
+    std::cerr << "usage: " << name << " [--speed <factor>] [--fps <rate>] [--headless] [--null] <capture>\n"
+              << "  <capture>   frame log written with Video.CapturePath, or a raw Annex-B H.264 stream\n"
+              << "  --speed     replay faster (>1) or slower (<1) than captured; 0 replays as fast as possible\n"
+              << "  --fps       frame rate assumed for raw streams (default 30)\n"
+              << "  --headless  decode into a fakesink without opening a window (GStreamer builds)\n"
+              << "  --null      discard frames instead of decoding them" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+
+        if(arg == "--speed" && i + 1 < argc)
+        {
+            options.speed = std::strtod(argv[++i], nullptr);
+        }
+        else if(arg == "--fps" && i + 1 < argc)
+        {
+            options.fps = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if(arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if(arg == "--null")
+        {
+            options.null = true;
+        }
+        else if(!arg.empty() && arg[0] != '-' && options.path.empty())
+        {
+            options.path = arg;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return !options.path.empty() && options.speed >= 0 && options.fps > 0;
+}
+
+// Must not run on the Qt thread: the Qt based outputs create their widgets
+// there with a blocking queued call.
+projection::IVideoOutput::Pointer createVideoOutput(const Options& options, autoapp::configuration::IConfiguration::Pointer configuration)
+{
+    if(options.null)
+    {
+        return std::make_shared<NullVideoOutput>(std::move(configuration));
+    }
+
+#if defined USE_OMX
+    return std::make_shared<projection::OMXVideoOutput>(std::move(configuration));
+#elif defined USE_GSTREAMER
+    return projection::IVideoOutput::Pointer(new projection::QuickGstVideoOutput(std::move(configuration), options.headless), std::bind(&QObject::deleteLater, std::placeholders::_1));
+#else
+    return projection::IVideoOutput::Pointer(new projection::QtVideoOutput(std::move(configuration)), std::bind(&QObject::deleteLater, std::placeholders::_1));
+#endif
+}
+
+// Feeds the capture to the output the way VideoService does: same
+// presentation timestamps, same drop policy, same tracing points.
+int replay(const Options& options, autoapp::configuration::IConfiguration::Pointer configuration)
+{
+    projection::VideoFrameLogReader reader;
+    if(!reader.open(options.path, 1000000 / options.fps))
+    {
+        return 1;
+    }
+
+    auto videoOutput = createVideoOutput(options, configuration);
+    auto latencyTracer = std::make_shared<projection::VideoLatencyTracer>(true);
+    videoOutput->setLatencyTracer(latencyTracer);
+
+    if(!videoOutput->open() || !videoOutput->init())
+    {
+        OPENAUTO_LOG(error) << "[videoreplay] video output failed to start.";
+        return 1;
+    }
+
+    projection::PresentationTimestampGenerator timestampGenerator;
+    projection::VideoFrameDropPolicy dropPolicy(configuration->getVideoDropThreshold());
+    projection::VideoFrameRecord record;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t lateFrames = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    while(reader.read(record))
+    {
+        if(options.speed > 0)
+        {
+            const auto due = start + std::chrono::microseconds(static_cast<uint64_t>(record.arrivalTime / options.speed));
+
+            if(std::chrono::steady_clock::now() > due + std::chrono::milliseconds(1))
+            {
+                // The previous write blocked past this frame's arrival time.
+                ++lateFrames;
+            }
+
+            std::this_thread::sleep_until(due);
+        }
+
+        const aasdk::common::DataConstBuffer buffer(record.payload);
+        const auto timestamp = timestampGenerator.generate(record.timestamp);
+        latencyTracer->record(projection::VideoLatencyTracer::Stage::RECEIVED, timestamp);
+
+        ++frames;
+        bytes += record.payload.size();
+
+        if(!dropPolicy.shouldDrop(buffer, videoOutput->getQueueDepth()))
+        {
+            videoOutput->write(timestamp, buffer);
+        }
+    }
+
+    const auto fed = std::chrono::steady_clock::now();
+
+    // Give the decoder a moment to work through its queue.
+    while(videoOutput->getQueueDepth() > 0 && std::chrono::steady_clock::now() - fed < std::chrono::seconds(2))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // OMX only shows when the decoder takes a frame in, not when it is done.
+    auto decoded = latencyTracer->getFrameCount(projection::VideoLatencyTracer::Stage::DECODED);
+    const char* decodedLabel = "decoded";
+    if(decoded == 0)
+    {
+        decoded = latencyTracer->getFrameCount(projection::VideoLatencyTracer::Stage::DECODER_INPUT);
+        decodedLabel = "taken by decoder";
+    }
+
+    videoOutput->stop();
+
+    OPENAUTO_LOG(info) << "[videoreplay] frames: " << frames
+                       << ", dropped: " << dropPolicy.getDroppedFrames()
+                       << ", late: " << lateFrames
+                       << ", " << decodedLabel << ": " << decoded
+                       << ", elapsed: " << elapsed << "s";
+    OPENAUTO_LOG(info) << "[videoreplay] fed " << frames / elapsed << " fps, "
+                       << bytes * 8 / elapsed / 1000000 << " Mbit/s, " << decodedLabel << " "
+                       << decoded / elapsed << " fps";
+    latencyTracer->dump();
+
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if(!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    if(options.headless || options.null)
+    {
+        // No display on a CI box.
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication qApplication(argc, argv);
+    auto configuration = std::make_shared<autoapp::configuration::Configuration>();
+
+    int result = 0;
+    std::thread replayThread([&]() {
+        result = replay(options, configuration);
+        QMetaObject::invokeMethod(&qApplication, "quit", Qt::QueuedConnection);
+    });
+
+    qApplication.exec();
+    replayThread.join();
+
+    return result;
+}